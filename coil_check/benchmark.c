@@ -0,0 +1,538 @@
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "decode.h"
+#include "encode.h"
+#include "level.h"
+
+// Microbenchmarks for the checker's hot loops: board parsing, sliding a path
+// and the qpath decisions, on synthetic boards with known solutions.
+
+enum
+{
+	CELL_FREE,
+	CELL_VISITED,
+	CELL_WALL,
+};
+
+// Growable byte string.
+typedef struct text
+{
+	char*  data;
+	size_t size;
+	size_t cap;
+} text;
+
+static void text_add(text* const t, char const* const s, size_t const n)
+{
+	if (t->size + n + 1 > t->cap)
+	{
+		while (t->size + n + 1 > t->cap) t->cap = t->cap ? t->cap * 2 : 256;
+		t->data = realloc(t->data, t->cap);
+		if (!t->data)
+		{
+			fprintf(stderr, "out of memory\n");
+			exit(EXIT_FAILURE);
+		}
+	}
+	memcpy(t->data + t->size, s, n);
+	t->size += n;
+	t->data[t->size] = '\0';
+}
+
+static void text_printf(text* const t, char const* const fmt, u4 const a, u4 const b)
+{
+	char buf[64];
+	int const n = snprintf(buf, sizeof(buf), fmt, a, b);
+	text_add(t, buf, n);
+}
+
+// A board with a blocked border, as the generators lay it out, and the
+// solution walked on it.
+typedef struct layout
+{
+	u4  w;       // Border included.
+	u4  h;
+	u1* cells;
+	s4  delta[4];
+	u4  start;
+	u1* dirs;    // Move directions, in delta order.
+	u4  moves;
+} layout;
+
+static void layout_init(layout* const l, u4 const board_w, u4 const board_h)
+{
+	l->w        = board_w + 2;
+	l->h        = board_h + 2;
+	l->cells    = malloc((size_t)l->w * l->h);
+	l->dirs     = malloc((size_t)l->w * l->h);
+	l->moves    = 0;
+	l->delta[0] = -1;
+	l->delta[1] = -(s4)l->w;
+	l->delta[2] = 1;
+	l->delta[3] = (s4)l->w;
+	if (!l->cells || !l->dirs)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (u4 y = 0; y != l->h; ++y)
+	{
+		for (u4 x = 0; x != l->w; ++x)
+		{
+			bool const border = x == 0 || y == 0 || x == l->w - 1 || y == l->h - 1;
+			l->cells[y * l->w + x] = border ? CELL_WALL : CELL_FREE;
+		}
+	}
+}
+
+static void layout_free(layout* const l)
+{
+	free(l->cells);
+	free(l->dirs);
+}
+
+// Slide from the start, always taking the first free direction in R, D, L, U
+// order, until stuck.  On an open field this is a spiral; in a serpentine it
+// follows the corridor.
+static void walk_first_free(layout* const l)
+{
+	static u1 const order[4] = { 2, 3, 0, 1 };
+	u4 i = l->start;
+	l->cells[i] = CELL_VISITED;
+	for (;;)
+	{
+		u4 k = 0;
+		while (k != 4 && l->cells[i + l->delta[order[k]]] != CELL_FREE) ++k;
+		if (k == 4) break;
+		s4 const d = l->delta[order[k]];
+		while (l->cells[i + d] == CELL_FREE) l->cells[i += d] = CELL_VISITED;
+		l->dirs[l->moves++] = order[k];
+	}
+}
+
+static void gen_open(layout* const l, u4 const w, u4 const h)
+{
+	layout_init(l, w, h);
+	l->start = l->w + 1;
+	walk_first_free(l);
+}
+
+// Rows of width one joined alternately at the right and left end.
+static void gen_serpentine(layout* const l, u4 const w, u4 const h)
+{
+	layout_init(l, w, h);
+	for (u4 y = 1; y < h; y += 2)
+	{
+		u4 const gap = y % 4 == 1 ? w - 1 : 0;
+		for (u4 x = 0; x != w; ++x)
+		{
+			if (x != gap) l->cells[(y + 1) * l->w + x + 1] = CELL_WALL;
+		}
+	}
+	l->start = l->w + 1;
+	walk_first_free(l);
+}
+
+static u8 rng_state = 0x9e3779b97f4a7c15ull;
+
+static u4 rng(u4 const n)
+{
+	rng_state ^= rng_state << 13;
+	rng_state ^= rng_state >> 7;
+	rng_state ^= rng_state << 17;
+	return (u4)((rng_state >> 32) % n);
+}
+
+// A move of the random walk, with the walls it put down so it can be undone.
+typedef struct step
+{
+	u4 pos;
+	u4 walls[4];
+	u1 n_walls;
+	u1 dir;
+	u4 len;
+} step;
+
+static void wall(layout* const l, step* const m, u4 const i)
+{
+	if (l->cells[i] != CELL_FREE) return;
+	l->cells[i]            = CELL_WALL;
+	m->walls[m->n_walls++] = i;
+}
+
+// Slide len cells from m->pos and wall the cell after.  The free neighbours
+// that come before dir in the checker's L, U, R, D scan are walled, too, so
+// that the qpath auto-continuation can never pick another direction here.
+static u4 take(layout* const l, step* const m, u1 const dir, u4 const len)
+{
+	s4 const d = l->delta[dir];
+	m->dir     = dir;
+	m->len     = len;
+	m->n_walls = 0;
+	for (u1 e = 0; e != dir; ++e) wall(l, m, m->pos + l->delta[e]);
+	for (u4 s = 1; s <= len; ++s) l->cells[m->pos + d * s] = CELL_VISITED;
+	wall(l, m, m->pos + d * (len + 1));
+	return m->pos + d * len;
+}
+
+static void undo(layout* const l, step const* const m)
+{
+	s4 const d = l->delta[m->dir];
+	for (u4 s = 1; s <= m->len; ++s) l->cells[m->pos + d * s] = CELL_FREE;
+	for (u4 k = 0; k != m->n_walls; ++k) l->cells[m->walls[k]] = CELL_FREE;
+}
+
+static u4 free_run(layout const* const l, u4 const i, u1 const dir, u4 const max)
+{
+	u4 run = 0;
+	while (run != max && l->cells[i + l->delta[dir] * (run + 1)] == CELL_FREE) ++run;
+	return run;
+}
+
+// A move of the dense walk and which of its options have been tried.
+typedef struct choice
+{
+	step m;
+	u4   first;
+	u4   tried;
+	u1   forward; // Direction the strip is crossed in.
+} choice;
+
+// Rows down from cell i to the wall row under its strip.
+static u4 to_gap(layout const* const l, u4 const i, u4 const strip)
+{
+	return strip - (i / l->w - 1) % (strip + 1);
+}
+
+// Dense walls: strips of the given height, separated by wall rows that have a
+// gap at alternating ends.  A random walk of short slides crosses each strip,
+// only going forward, up or down, then drops through the gap into the next.
+// Each slide is stopped by a wall put down right after it, and every cell the
+// walk misses is a wall, so the walk is a solution by construction.  When the
+// walk boxes itself in, it backs up and tries other slides.
+static void gen_dense(layout* const l, u4 const w, u4 const h, u4 const strip, u4 const max_run)
+{
+	layout_init(l, w, h);
+	for (u4 y = strip; y < h; y += strip + 1)
+	{
+		u4 const gap = y / (strip + 1) % 2 == 0 ? w - 1 : 0;
+		for (u4 x = 0; x != w; ++x)
+		{
+			if (x != gap) l->cells[(y + 1) * l->w + x + 1] = CELL_WALL;
+		}
+	}
+
+	// The moves taken so far; the one on top is being chosen.
+	u4 const options = 3 * max_run;
+	u4       cap     = 1024;
+	u4       depth   = 0;
+	choice*  stack   = malloc(cap * sizeof(*stack));
+	if (!stack)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	l->start           = l->w + 1;
+	l->cells[l->start] = CELL_VISITED;
+	stack[0].m.pos     = l->start;
+	stack[0].first     = rng(options);
+	stack[0].tried     = 0;
+	stack[0].forward   = 2;
+	for (u8 budget = 64ull * w * h; budget != 0; --budget)
+	{
+		choice* const c       = &stack[depth];
+		u4 const      i       = c->m.pos;
+		u4 const      end_x   = c->forward == 2 ? l->w - 2 : 1;
+		u1            forward = c->forward;
+		u4            to      = 0;
+		if (i % l->w == end_x)
+		{
+			// Drop into the next strip, or stop if this is the last.
+			u4 const down = to_gap(l, i, strip);
+			if (i / l->w + down >= l->h - 1) break;
+			u4 const run = free_run(l, i, 3, down + strip);
+			if (c->tried++ == 0 && run > down)
+			{
+				to       = take(l, &c->m, 3, down + 1 + rng(run - down));
+				forward ^= 2;
+			}
+		}
+		else
+		{
+			u1 const dirs[3] = { forward, 1, 3 };
+			while (to == 0 && c->tried != options)
+			{
+				u4 const option = (c->first + c->tried++) % options;
+				u1 const dir    = dirs[option % 3];
+				u4 const len    = 1 + option / 3;
+				if (free_run(l, i, dir, len) != len) continue;
+				to = take(l, &c->m, dir, len);
+			}
+		}
+
+		if (to == 0)
+		{
+			if (depth == 0) break;
+			--depth;
+			undo(l, &stack[depth].m);
+			continue;
+		}
+
+		if (++depth == cap)
+		{
+			choice* const grown = realloc(stack, (cap *= 2) * sizeof(*stack));
+			if (!grown)
+			{
+				fprintf(stderr, "out of memory\n");
+				exit(EXIT_FAILURE);
+			}
+			stack = grown;
+		}
+		choice* const next = &stack[depth];
+		next->m.pos   = to;
+		next->first   = rng(options);
+		next->tried   = 0;
+		next->forward = forward;
+	}
+
+	for (u4 k = 0; k != depth; ++k) l->dirs[l->moves++] = stack[k].m.dir;
+	free(stack);
+}
+
+// Write the layout's board, with visited cells free and the rest walls.
+static void write_board(layout const* const l, text* const t)
+{
+	text_printf(t, "x=%u&y=%u&board=", l->w - 2, l->h - 2);
+	for (u4 y = 1; y != l->h - 1; ++y)
+	{
+		for (u4 x = 1; x != l->w - 1; ++x)
+		{
+			text_add(t, l->cells[y * l->w + x] == CELL_VISITED ? "." : "X", 1);
+		}
+	}
+}
+
+// Write the solution as a path, or as a qpath with the moves the checker
+// makes by itself left out.  Returns false unless the walk covers the board
+// and, for a qpath, can be written as one.
+static bool write_solution(layout const* const l, bool const compressed, text* const t)
+{
+	u4 const x = l->start % l->w - 1;
+	u4 const y = l->start / l->w - 1;
+	text_printf(t, "x=%u&y=%u", x, y);
+	text_add(t, compressed ? "&qpath=" : "&path=", compressed ? 7 : 6);
+
+	// Replay the walk on a grid of its own, with just the visited cells free.
+	size_t const area  = (size_t)l->w * l->h;
+	u1* const    cells = malloc(area);
+	char* const  moves = malloc(l->moves + 1);
+	if (!cells || !moves)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+	for (size_t i = 0; i != area; ++i) cells[i] = l->cells[i] == CELL_VISITED;
+	u4   len = l->moves;
+	bool ok  = true;
+	if (compressed)
+	{
+		ok = encode_qpath(cells, l->delta, l->start, l->dirs, l->moves, moves, &len);
+	}
+	else
+	{
+		u4 i = l->start;
+		cells[i] = 0;
+		for (u4 m = 0; m != l->moves; ++m)
+		{
+			s4 const d = l->delta[l->dirs[m]];
+			moves[m] = move_char[l->dirs[m]];
+			while (cells[i + d]) cells[i += d] = 0;
+		}
+	}
+	ok = ok && memchr(cells, 1, area) == NULL;
+	if (ok) text_add(t, moves, len);
+	free(cells);
+	free(moves);
+	return ok;
+}
+
+typedef struct sample
+{
+	char name[32];
+	text board;
+	text path;
+	text qpath;
+	u4   cells; // Board cells, walls included.
+	u4   free;  // Free cells.
+	u4   moves;
+} sample;
+
+static void sample_make(sample* const s, char const* const kind, layout* const l)
+{
+	memset(s, 0, sizeof(*s));
+	snprintf(s->name, sizeof(s->name), "%s %ux%u", kind, l->w - 2, l->h - 2);
+	s->cells = (l->w - 2) * (l->h - 2);
+	s->moves = l->moves;
+	for (u4 i = 0; i != l->w * l->h; ++i) s->free += l->cells[i] == CELL_VISITED;
+	write_board(l, &s->board);
+	if (!write_solution(l, false, &s->path) || !write_solution(l, true, &s->qpath))
+	{
+		fprintf(stderr, "%s: generated walk does not encode\n", s->name);
+		exit(EXIT_FAILURE);
+	}
+	layout_free(l);
+}
+
+static double now(void)
+{
+	struct timespec t;
+	clock_gettime(CLOCK_MONOTONIC, &t);
+	return t.tv_sec + t.tv_nsec * 1e-9;
+}
+
+static bool force_packed = false;
+
+static void load(grid* const g, sample const* const s, u4* const n)
+{
+	char error[ERROR_SIZE];
+	if (!level_load(g, s->board.data, s->board.data + s->board.size, force_packed ? LAYOUT_PACKED : LAYOUT_AUTO, false, n, error))
+	{
+		fprintf(stderr, "%s: %s\n", s->name, error);
+		exit(EXIT_FAILURE);
+	}
+}
+
+// Seconds to decode the solution in t, on a freshly loaded board.
+static double time_decode(grid* const g, sample const* const s, text const* const t)
+{
+	u4 n;
+	load(g, s, &n);
+	decoder d;
+	double const start = now();
+	decoder_init(&d, g, n);
+	bool const ok = decoder_feed(&d, t->data, t->size) && decoder_finish(&d);
+	double const end = now();
+	if (!ok)
+	{
+		fprintf(stderr, "%s: generated solution does not check: %s\n", s->name, d.message);
+		exit(EXIT_FAILURE);
+	}
+	return end - start;
+}
+
+static int by_value(void const* const a, void const* const b)
+{
+	double const x = *(double const*)a;
+	double const y = *(double const*)b;
+	return x < y ? -1 : x > y;
+}
+
+// Print the 10th, 50th and 90th percentile of count / seconds over the runs.
+static void report(char const* const name, char const* const kernel, char const* const unit, double const count, double const* const secs, u4 const runs)
+{
+	double rate[runs];
+	for (u4 r = 0; r != runs; ++r) rate[r] = count / secs[r] * 1e-6;
+	qsort(rate, runs, sizeof(*rate), by_value);
+	u4 const p10 = runs / 10;
+	u4 const p50 = runs / 2;
+	u4 const p90 = runs - 1 - runs / 10;
+	printf("%-20s %-6s %-9s %10.2f %10.2f %10.2f\n", name, kernel, unit, rate[p10], rate[p50], rate[p90]);
+}
+
+static void bench(sample const* const s, u4 const runs)
+{
+	grid    g = { 0 };
+	double* t = malloc(runs * sizeof(*t));
+	if (!t)
+	{
+		fprintf(stderr, "out of memory\n");
+		exit(EXIT_FAILURE);
+	}
+
+	for (u4 r = 0; r != runs; ++r)
+	{
+		u4 n;
+		double const start = now();
+		load(&g, s, &n);
+		t[r] = now() - start;
+	}
+	report(s->name, "parse", "Mcell/s", s->cells, t, runs);
+
+	for (u4 r = 0; r != runs; ++r) t[r] = time_decode(&g, s, &s->path);
+	report(s->name, "slide", "Mcell/s", s->free, t, runs);
+	report(s->name, "slide", "Mmove/s", s->moves, t, runs);
+
+	for (u4 r = 0; r != runs; ++r) t[r] = time_decode(&g, s, &s->qpath);
+	report(s->name, "qpath", "Mmove/s", s->moves, t, runs);
+
+	free(t);
+	grid_release(&g);
+}
+
+static int usage(char const* const prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-p] [-n <runs>]\n"
+		"Options:\n"
+		"  -p    Use the packed grid regardless of board size\n"
+		"  -n    Timed runs per kernel (default 20)\n",
+		prog);
+	return EXIT_FAILURE;
+}
+
+int main(int const argc, char** const argv)
+{
+	u4  runs = 20;
+	int opt;
+	while ((opt = getopt(argc, argv, "pn:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'p':
+				force_packed = true;
+				break;
+			case 'n':
+				runs = strtoul(optarg, NULL, 10);
+				if (runs == 0) runs = 1;
+				break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+
+	sample samples[4];
+	layout l;
+	gen_open(&l, 1000, 1000);
+	sample_make(&samples[0], "open", &l);
+	gen_serpentine(&l, 1000, 999);
+	sample_make(&samples[1], "serpentine", &l);
+	gen_dense(&l, 1000, 1000, 6, 4);
+	sample_make(&samples[2], "dense", &l);
+	gen_dense(&l, 2000, 2000, 6, 4);
+	sample_make(&samples[3], "dense", &l);
+
+	printf("%-20s %-6s %-9s %10s %10s %10s\n", "board", "kernel", "unit", "p10", "p50", "p90");
+	for (u4 k = 0; k != 4; ++k)
+	{
+		sample const* const s = &samples[k];
+		fprintf(stderr, "%s: %u free cells, %u moves, %zu byte path, %zu byte qpath\n",
+			s->name, s->free, s->moves, s->path.size, s->qpath.size);
+	}
+	for (u4 k = 0; k != 4; ++k) bench(&samples[k], runs);
+
+	for (u4 k = 0; k != 4; ++k)
+	{
+		free(samples[k].board.data);
+		free(samples[k].path.data);
+		free(samples[k].qpath.data);
+	}
+	return EXIT_SUCCESS;
+}
@@ -1,20 +1,32 @@
+#define _GNU_SOURCE
+
+#include <stdarg.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <getopt.h>
+#include <pthread.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/time.h>
 
-typedef unsigned char u1;
-typedef   signed int  s4;
-typedef unsigned int  u4;
+#include "decode.h"
+#include "input.h"
+#include "level.h"
+#include "parse.h"
+#include "report.h"
 
 // Global variables
 bool debug_mode = false;
-u4 board_w, board_h, w, h;
-u1* board = NULL;
+bool force_packed = false;
+bool report_mode  = false;
+bool usage_mode   = false;
 
 // Function to print the board state for debugging
-void print_board_state(u1* b, u4 w, u4 h, u4 curr_x, u4 curr_y)
+void print_board_state(grid const* g, u4 w, u4 h, u4 curr_x, u4 curr_y)
 {
     fprintf(stderr, "\nBoard state (%ux%u):\n", w-2, h-2);
     fprintf(stderr, "Current position: (%u,%u)\n", curr_x-1, curr_y-1);
@@ -34,18 +46,18 @@ void print_board_state(u1* b, u4 w, u4 h, u4 curr_x, u4 curr_y)
         
         for (u4 x = 1; x < w - 1; ++x)
         {
-            u1 cell = b[y * w + x];
+            bool empty = grid_free(g, y * w + x);
             
             // Highlight current position
             if (x == curr_x && y == curr_y)
             {
                 fprintf(stderr, "@ ");
             }
-            else if (cell == 0)
+            else if (!empty)
             {
                 // Cell is either a wall or has been visited
                 // Check original board to distinguish
-                if (board[y * w + x] == 0)
+                if (!bit_test(g->orig, y * w + x))
                 {
                     fprintf(stderr, "X "); // Wall
                 }
@@ -64,276 +76,870 @@ void print_board_state(u1* b, u4 w, u4 h, u4 curr_x, u4 curr_y)
     fprintf(stderr, "\n");
 }
 
-int main(int const argc, char** const argv)
+// Store a formatted error message and fail.  Debug mode also reports it on
+// stderr right away, ahead of any board dump that follows.
+static bool fail(char* const error, char const* const fmt, ...)
 {
-    // Parse command line options
-    int opt;
-    while ((opt = getopt(argc, argv, "d")) != -1)
-    {
-        switch (opt)
-        {
-            case 'd':
-                debug_mode = true;
-                break;
-            default:
-                fprintf(stderr,
-                    "Usage: %s [-d] <board filename> <solution filename>\n"
-                    "Options:\n"
-                    "  -d    Enable debug mode\n"
-                    "File formats:\n"
-                    "  board:    x=<x>&y=<y>&board=<board>\n"
-                    "  solution: x=<x>&y=<y>&path=<path>\n"
-                    "            x=<x>&y=<y>&qpath=<qpath>\n",
-                    argv[0]);
-                return EXIT_FAILURE;
-        }
-    }
-    
-    // Check if we have the required arguments
-    if (optind + 2 > argc)
-    {
-        fprintf(stderr,
-            "Usage: %s [-d] <board filename> <solution filename>\n"
-            "Options:\n"
-            "  -d    Enable debug mode\n"
-            "File formats:\n"
-            "  board:    x=<x>&y=<y>&board=<board>\n"
-            "  solution: x=<x>&y=<y>&path=<path>\n"
-            "            x=<x>&y=<y>&qpath=<qpath>\n",
-            argv[0]);
-        return EXIT_FAILURE;
-    }
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(error, ERROR_SIZE, fmt, args);
+	va_end(args);
+	if (debug_mode) fprintf(stderr, "%s\n", error);
+	return false;
+}
 
-	// Read board.
-	FILE* const f = fopen(argv[optind], "r");
-	if (!f)
+// Load the board named by spec into g.  On success the number of free cells
+// is stored in n.
+static bool load_board(grid* const g, char const* const spec, u4* const n, char* const error)
+{
+	if (level_read(g, spec, force_packed ? LAYOUT_PACKED : LAYOUT_AUTO, debug_mode, n, error)) return true;
+	if (debug_mode) fprintf(stderr, "%s\n", error);
+	return false;
+}
+
+// Parse the board in [p, end) into g, as load_board().
+static bool load_inline_board(grid* const g, char const* const p, char const* const end, u4* const n, char* const error)
+{
+	if (level_load(g, p, end, force_packed ? LAYOUT_PACKED : LAYOUT_AUTO, debug_mode, n, error)) return true;
+	if (debug_mode) fprintf(stderr, "%s\n", error);
+	return false;
+}
+
+// Render the failure report for a failed decode, or NULL if out of memory.
+static char* failure_report(decoder const* const d)
+{
+	report r;
+	if (!report_build(&r, d)) return NULL;
+
+	char*       text = NULL;
+	size_t      size = 0;
+	FILE* const out  = open_memstream(&text, &size);
+	if (!out) return NULL;
+	report_print(out, &r);
+	fclose(out);
+	return text;
+}
+
+// Pass a failed decode on to the caller, with the failure report if asked for
+// and the board dump in debug mode.
+static bool decode_failed(decoder const* const d, char* const error, char** const report)
+{
+	grid const* const b = d->g;
+	u4 const          w = b->w;
+	u4 const          h = b->h;
+	fail(error, "%s", d->message);
+	if (report_mode) *report = failure_report(d);
+	if (!debug_mode) return false;
+
+	// Calculate current position
+	u4 const curr_x = d->pos % w;
+	u4 const curr_y = d->pos / w;
+	switch (d->error)
 	{
-		fprintf(stderr, "failed to open board\n");
-		return EXIT_FAILURE;
+		case DECODE_OFF_BOARD:
+			fprintf(stderr, "Board dimensions: %ux%u\n", w - 2, h - 2);
+			fprintf(stderr, "Start position: (%u,%u)\n", d->start_x, d->start_y);
+			break;
+
+		case DECODE_START_BLOCKED:
+			print_board_state(b, w, h, curr_x, curr_y);
+			break;
+
+		case DECODE_BLOCKED:
+			fprintf(stderr, "Attempted direction: %c\n", d->attempted);
+			print_board_state(b, w, h, curr_x, curr_y);
+			break;
+
+		case DECODE_INCOMPLETE:
+			print_board_state(b, w, h, curr_x, curr_y);
+			fprintf(stderr, "Remaining unvisited cells: %u\n", d->remaining);
+			break;
+
+		default:
+			break;
 	}
+	return false;
+}
 
-	if (fscanf(f, "x=%u&y=%u&board=", &board_w, &board_h) != 2)
+// Walk a solution over a board loaded by load_board().
+static bool check_path(grid* const b, u4 const n, char const* const q, char const* const q_end, char* const error, char** const report)
+{
+	decoder d;
+	decoder_init(&d, b, n);
+	if (!decoder_feed(&d, q, q_end - q) || !decoder_finish(&d)) return decode_failed(&d, error, report);
+	return true;
+}
+
+// Check a solution file.  Regular files are decoded straight from the mapped
+// bytes; pipes are decoded chunk by chunk as the writer produces them, and
+// left at the first invalid move.
+static bool check_path_file(grid* const b, u4 const n, char const* const name, char* const error, char** const report)
+{
+	int const fd = strcmp(name, "-") == 0 ? STDIN_FILENO : open(name, O_RDONLY);
+	if (fd < 0) return fail(error, "failed to open solution");
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode))
 	{
-		fprintf(stderr, "could not parse board size\n");
-		return EXIT_FAILURE;
+		if (fd != STDIN_FILENO) close(fd);
+		input g;
+		if (!input_open(&g, name)) return fail(error, "failed to open solution");
+		bool const ok = check_path(b, n, g.data, g.data + g.size, error, report);
+		input_close(&g);
+		return ok;
 	}
 
-	// Add a blocked border.
-	u4        n = 0;
-	h = board_h + 2;
-	w = board_w + 2;
+	decoder d;
+	decoder_init(&d, b, n);
+	char chunk[1 << 16];
+	bool ok = true;
+	while (ok && !decoder_ended(&d))
+	{
+		ssize_t const r = read(fd, chunk, sizeof(chunk));
+		if (r < 0)
+		{
+			ok = fail(error, "read error");
+			break;
+		}
+		if (r == 0) break;
+		ok = decoder_feed(&d, chunk, r);
+	}
+	if (fd != STDIN_FILENO) close(fd);
+	if (!ok) return d.error != DECODE_OK ? decode_failed(&d, error, report) : false;
+	return decoder_finish(&d) || decode_failed(&d, error, report);
+}
+
 
-	u1* const b = calloc(h * w, sizeof(*b));
-	if (!b)
+static void print_json_string(FILE* const out, char const* s)
+{
+	fputc('"', out);
+	for (; *s; ++s)
 	{
-		fprintf(stderr, "out of memory\n");
-		return EXIT_FAILURE;
+		if (*s == '"' || *s == '\\') fprintf(out, "\\%c", *s);
+		else if ((unsigned char)*s < 0x20) fprintf(out, "\\u%04x", (unsigned char)*s);
+		else fputc(*s, out);
 	}
+	fputc('"', out);
+}
+
+static double seconds(struct timeval const t)
+{
+	return t.tv_sec + t.tv_usec / 1e6;
+}
 
-	// Create a copy of the original board for debugging
-	if (debug_mode)
+// One line per record, flushed right away so a driver can wait for it.
+static void print_verdict(u4 const record, bool const ok, char const* const error, char const* const report, struct rusage const* const used)
+{
+	printf("{\"record\":%u,\"ok\":%s", record, ok ? "true" : "false");
+	if (!ok)
+	{
+		printf(",\"error\":");
+		print_json_string(stdout, error);
+	}
+	if (report) printf(",\"report\":%s", report);
+	if (used)
 	{
-		board = calloc(h * w, sizeof(*board));
-		if (!board)
+		printf(",\"usage\":{\"user\":%.6f,\"sys\":%.6f,\"max_rss_kb\":%ld,\"major_faults\":%ld,\"context_switches\":%ld}",
+			seconds(used->ru_utime), seconds(used->ru_stime), used->ru_maxrss, used->ru_majflt, used->ru_nvcsw + used->ru_nivcsw);
+	}
+	printf("}\n");
+	fflush(stdout);
+}
+
+// A board and solution pair from batch or manifest input.
+typedef struct record
+{
+	char*  board;        // Board filename, or the board itself if inline.
+	char*  solution;     // Solution bytes, or a solution filename in manifest mode.
+	u4     size;         // Number of solution bytes.
+	u4     board_size;   // Number of board bytes, if inline.
+	bool   inline_board;
+	u8     area;         // Board cells, for scheduling.
+	bool   done;
+	bool   ok;
+	char   error[ERROR_SIZE];
+	char*  report;       // Failure report, with -r.
+	struct rusage used;  // Resources checking it took, with -u.
+} record;
+
+static void record_release(record* const r)
+{
+	free(r->board);
+	free(r->solution);
+	free(r->report);
+	r->board    = NULL;
+	r->solution = NULL;
+	r->report   = NULL;
+}
+
+// Read the next record.  Batch input is a header line
+// "length=<n>&board=<path>" followed by exactly n bytes of solution, or
+// "length=<n>&boardlength=<m>" followed by m bytes of board and then the n
+// bytes of solution; a manifest has a "<board path>\t<solution path>" line
+// per record.  Returns 1 for a record, 0 at the end of input and -1 on
+// malformed input.
+static int read_record(FILE* const in, bool const manifest, u4 const index, record* const r)
+{
+	char*   line = NULL;
+	size_t  cap  = 0;
+	ssize_t len  = getline(&line, &cap, in);
+	memset(r, 0, sizeof(*r));
+	if (len <= 0)
+	{
+		free(line);
+		return 0;
+	}
+	if (line[len - 1] == '\n') line[--len] = '\0';
+
+	if (manifest)
+	{
+		char* const tab = strchr(line, '\t');
+		if (!tab)
 		{
-			fprintf(stderr, "out of memory for debug board\n");
-			free(b);
-			return EXIT_FAILURE;
+			fprintf(stderr, "could not parse manifest line %u\n", index + 1);
+			free(line);
+			return -1;
 		}
+		*tab        = '\0';
+		r->solution = strdup(tab + 1);
+		r->board    = line;
+		if (!r->solution) goto oom;
+		return 1;
 	}
 
-	for (u4 y = 1; y != h - 1; ++y)
+	char const* p = line;
+	if (!parse_lit(&p, line + len, "length=") || !parse_u4(&p, line + len, &r->size) ||
+			!parse_lit(&p, line + len, "&board"))
 	{
-		for (u4 x = 1; x != w - 1; ++x)
+		fprintf(stderr, "could not parse batch record %u\n", index + 1);
+		free(line);
+		return -1;
+	}
+	r->inline_board = parse_lit(&p, line + len, "length=");
+	if (r->inline_board ? !parse_u4(&p, line + len, &r->board_size) || p != line + len : !parse_lit(&p, line + len, "="))
+	{
+		fprintf(stderr, "could not parse batch record %u\n", index + 1);
+		free(line);
+		return -1;
+	}
+	if (r->inline_board)
+	{
+		free(line);
+		r->board = malloc(r->board_size + 1);
+		if (!r->board) goto oom;
+		if (fread(r->board, 1, r->board_size, in) != r->board_size)
 		{
-			u1 c;
-			switch (fgetc(f))
-			{
-				case 'X': c = 0;      break;
-				case '.': c = 1; ++n; break;
-
-				case EOF:
-					if (ferror(f))
-					{
-						fprintf(stderr, "read error\n");
-					}
-					else
-					{
-						fprintf(stderr, "board too short\n");
-					}
-					return EXIT_FAILURE;
-
-				default:
-					fprintf(stderr, "invalid board char at %ux%u\n", y - 1, x - 1);
-					return EXIT_FAILURE;
-			}
-			b[y * w + x] = c;
-			if (debug_mode)
-			{
-				board[y * w + x] = c;
-			}
+			fprintf(stderr, "batch record %u is truncated\n", index + 1);
+			record_release(r);
+			return -1;
 		}
 	}
-	fclose(f);
+	else
+	{
+		memmove(line, p, line + len + 1 - p);
+		r->board = line;
+	}
+	r->solution = malloc(r->size + 1);
+	if (!r->solution) goto oom;
+	if (fread(r->solution, 1, r->size, in) != r->size)
+	{
+		fprintf(stderr, "batch record %u is truncated\n", index + 1);
+		record_release(r);
+		return -1;
+	}
+	return 1;
 
-	// Check solution.
-	FILE* const g = fopen(argv[optind + 1], "r");
-	if (!g)
+oom:
+	fprintf(stderr, "out of memory\n");
+	record_release(r);
+	return -1;
+}
+
+// Check the solution in [sol, sol_end) against the board of record r.
+static bool check_record(grid* const g, record* const r, char const* const sol, char const* const sol_end)
+{
+	u4 n;
+	bool const loaded = r->inline_board ?
+		load_inline_board(g, r->board, r->board + r->board_size, &n, r->error) :
+		load_board(g, r->board, &n, r->error);
+	return loaded && check_path(g, n, sol, sol_end, r->error, &r->report);
+}
+
+static void verify_record(grid* const g, bool const manifest, record* const r)
+{
+	if (!manifest)
 	{
-		fprintf(stderr, "failed to open solution\n");
-		return EXIT_FAILURE;
+		r->ok = check_record(g, r, r->solution, r->solution + r->size);
+		return;
 	}
 
-	u4   start_y;
-	u4   start_x;
-	char path[7];
-	if (fscanf(g, "x=%u&y=%u&%6[^=]=", &start_x, &start_y, path) != 3)
+	input s;
+	if (!input_open(&s, r->solution))
 	{
-		fprintf(stderr, "could not parse start position\n");
-		return EXIT_FAILURE;
+		r->ok = fail(r->error, "failed to open solution");
+		return;
 	}
+	r->ok = check_record(g, r, s.data, s.data + s.size);
+	input_close(&s);
+}
 
-	bool compressed;
-	if (strcmp(path, "path") == 0)
+// Peak RSS of this process in kB.  ru_maxrss would include the RSS of the
+// process that started us at the time it did, which Linux carries across
+// exec, so the high-water mark of our own memory is read where there is one.
+static long peak_rss(void)
+{
+	long        peak = 0;
+	FILE* const f    = fopen("/proc/self/status", "r");
+	if (f)
 	{
-		compressed = false;
+		char line[256];
+		while (fgets(line, sizeof(line), f) && sscanf(line, "VmHWM: %ld", &peak) != 1) {}
+		fclose(f);
 	}
-	else if (strcmp(path, "qpath") == 0)
+	if (peak == 0)
 	{
-		compressed = true;
+		struct rusage self;
+		getrusage(RUSAGE_SELF, &self);
+		peak = self.ru_maxrss;
 	}
-	else
+	return peak;
+}
+
+// Check a record.  Its resource usage is that of the checking thread, but
+// the peak RSS is the whole process's.
+static void check_one(grid* const g, bool const manifest, record* const r)
+{
+	struct rusage before;
+	struct rusage after;
+	if (usage_mode) getrusage(RUSAGE_THREAD, &before);
+	verify_record(g, manifest, r);
+	if (!usage_mode) return;
+
+	getrusage(RUSAGE_THREAD, &after);
+	timersub(&after.ru_utime, &before.ru_utime, &r->used.ru_utime);
+	timersub(&after.ru_stime, &before.ru_stime, &r->used.ru_stime);
+	r->used.ru_maxrss = peak_rss();
+	r->used.ru_majflt = after.ru_majflt - before.ru_majflt;
+	r->used.ru_nvcsw  = after.ru_nvcsw - before.ru_nvcsw;
+	r->used.ru_nivcsw = after.ru_nivcsw - before.ru_nivcsw;
+}
+
+// Board cells according to the size header in [p, end), or 0 if it cannot be
+// read.
+static u8 header_area(char const* p, char const* const end)
+{
+	u4 x;
+	u4 y;
+	if (!parse_lit(&p, end, "x=") || !parse_u4(&p, end, &x) ||
+			!parse_lit(&p, end, "&y=") || !parse_u4(&p, end, &y))
 	{
-		fprintf(stderr, "did not recognize path type\n");
-		return EXIT_FAILURE;
+		return 0;
 	}
+	return (u8)x * y;
+}
+
+// Board cells of a record, for scheduling, or 0 if they cannot be read.
+static u8 board_area(record const* const r)
+{
+	if (r->inline_board) return header_area(r->board, r->board + r->board_size);
+
+	int const fd = open(r->board, O_RDONLY);
+	if (fd < 0) return 0;
+	char    head[64];
+	ssize_t len = read(fd, head, sizeof(head));
+	close(fd);
+	if (len <= 0) return 0;
+	return header_area(head, head + len);
+}
+
+// Records are handed out largest board first over per-worker deques.  A
+// worker takes from the front of its own deque and, once that is empty,
+// steals from the back of the others', so the small boards fill in the gaps
+// and the large ones do not end up at the tail.
+typedef struct deque
+{
+	pthread_mutex_t lock;
+	u4*             items;
+	u4              head;
+	u4              tail;
+} deque;
 
-	if (start_y >= board_h || start_x >= board_w)
+typedef struct pool
+{
+	record*         records;
+	bool            manifest;
+	u4              workers;
+	deque*          deques;
+	pthread_mutex_t done_lock;
+	pthread_cond_t  done_cond;
+} pool;
+
+typedef struct worker
+{
+	pool* pool;
+	u4    id;
+} worker;
+
+static bool deque_take(deque* const q, bool const front, u4* const item)
+{
+	pthread_mutex_lock(&q->lock);
+	bool const got = q->head != q->tail;
+	if (got) *item = front ? q->items[q->head++] : q->items[--q->tail];
+	pthread_mutex_unlock(&q->lock);
+	return got;
+}
+
+static void* worker_main(void* const arg)
+{
+	worker const* const self = arg;
+	pool*         const p    = self->pool;
+	grid                g    = { 0 };
+	for (;;)
 	{
-		fprintf(stderr, "start position not on board\n");
-		if (debug_mode)
+		u4   item;
+		bool got = deque_take(&p->deques[self->id], true, &item);
+		for (u4 k = 1; !got && k != p->workers; ++k)
 		{
-			fprintf(stderr, "Board dimensions: %ux%u\n", board_w, board_h);
-			fprintf(stderr, "Start position: (%u,%u)\n", start_x, start_y);
+			got = deque_take(&p->deques[(self->id + k) % p->workers], false, &item);
 		}
-		free(b);
-		if (debug_mode) free(board);
-		return EXIT_FAILURE;
+		if (!got) break;
+
+		record* const r = &p->records[item];
+		check_one(&g, p->manifest, r);
+
+		pthread_mutex_lock(&p->done_lock);
+		r->done = true;
+		pthread_cond_broadcast(&p->done_cond);
+		pthread_mutex_unlock(&p->done_lock);
 	}
+	grid_release(&g);
+	return NULL;
+}
 
-	u4 y = start_y + 1;
-	u4 x = start_x + 1;
+static record* sort_records;
 
-	u1* i = &b[y * w + x];
-	if (!*i)
+static int by_area_desc(void const* const a, void const* const b)
+{
+	u8 const x = sort_records[*(u4 const*)a].area;
+	u8 const y = sort_records[*(u4 const*)b].area;
+	if (x != y) return x > y ? -1 : 1;
+	return *(u4 const*)a < *(u4 const*)b ? -1 : 1;
+}
+
+// Check all records on a pool of workers, printing the verdicts in input order
+// as soon as each one and all before it are done.
+static int check_parallel(record* const records, u4 const count, bool const manifest, u4 workers)
+{
+	if (workers > count) workers = count ? count : 1;
+
+	u4*        order   = malloc(count * sizeof(*order) + 1);
+	deque*     deques  = calloc(workers, sizeof(*deques));
+	worker*    selves  = calloc(workers, sizeof(*selves));
+	pthread_t* threads = calloc(workers, sizeof(*threads));
+	u4*        items   = malloc(count * sizeof(*items) + 1);
+	if (!order || !deques || !selves || !threads || !items)
 	{
-		fprintf(stderr, "start position is blocked\n");
-		if (debug_mode)
-		{
-			print_board_state(b, w, h, x, y);
-		}
-		free(b);
-		if (debug_mode) free(board);
+		fprintf(stderr, "out of memory\n");
+		free(order);
+		free(deques);
+		free(selves);
+		free(threads);
+		free(items);
 		return EXIT_FAILURE;
 	}
 
-	n -= 1;
-	*i = 0;
+	for (u4 i = 0; i != count; ++i)
+	{
+		order[i]         = i;
+		records[i].area = board_area(&records[i]);
+	}
+	sort_records = records;
+	qsort(order, count, sizeof(*order), by_area_desc);
 
-	s4 const delta[] = { -1, -(s4)w, 1, (s4)w };
+	// Deal the records out round robin, so every worker starts on a big one.
+	u4 next = 0;
+	for (u4 k = 0; k != workers; ++k)
+	{
+		deque* const q = &deques[k];
+		pthread_mutex_init(&q->lock, NULL);
+		q->items = items + next;
+		for (u4 i = k; i < count; i += workers) items[next++] = order[i];
+		q->tail = next - (q->items - items);
+	}
 
-	for (;;)
+	pool p = { records, manifest, workers, deques, PTHREAD_MUTEX_INITIALIZER, PTHREAD_COND_INITIALIZER };
+	u4 started = 0;
+	for (; started != workers; ++started)
 	{
-		s4 d;
-		switch (fgetc(g))
-		{
-			case 'L': d = delta[0]; break;
-			case 'U': d = delta[1]; break;
-			case 'R': d = delta[2]; break;
-			case 'D': d = delta[3]; break;
+		selves[started].pool = &p;
+		selves[started].id   = started;
+		if (pthread_create(&threads[started], NULL, worker_main, &selves[started]) != 0) break;
+	}
+	if (started == 0)
+	{
+		// No threads to be had; check everything on this one, stealing from
+		// every deque in turn.
+		selves[0].pool = &p;
+		selves[0].id   = 0;
+		worker_main(&selves[0]);
+	}
 
-			case EOF:
-				if (ferror(g))
-				{
-					fprintf(stderr, "read error\n");
-					return EXIT_FAILURE;
-				}
-				/* FALLTHROUGH */
-			case '\r':
-			case '\n':
-				goto end_of_path;
-
-			default:
-				fprintf(stderr, "invalid char in path\n");
-				return EXIT_FAILURE;
-		}
+	for (u4 i = 0; i != count; ++i)
+	{
+		pthread_mutex_lock(&p.done_lock);
+		while (!records[i].done) pthread_cond_wait(&p.done_cond, &p.done_lock);
+		pthread_mutex_unlock(&p.done_lock);
+		print_verdict(i, records[i].ok, records[i].error, records[i].report, usage_mode ? &records[i].used : NULL);
+	}
+
+	for (u4 k = 0; k != started; ++k) pthread_join(threads[k], NULL);
+	for (u4 k = 0; k != workers; ++k) pthread_mutex_destroy(&deques[k].lock);
+	free(order);
+	free(deques);
+	free(selves);
+	free(threads);
+	free(items);
+	return EXIT_SUCCESS;
+}
+
+// Check batch or manifest records.  With one job each record is checked as
+// soon as it has been read; with more, all records are read first and then
+// checked in parallel.
+static int run_records(char const* const name, bool const manifest, u4 const jobs)
+{
+	FILE* const in = strcmp(name, "-") == 0 ? stdin : fopen(name, "r");
+	if (!in)
+	{
+		fprintf(stderr, "failed to open manifest\n");
+		return EXIT_FAILURE;
+	}
 
-		if (!i[d])
+	int status = EXIT_SUCCESS;
+	if (jobs == 1)
+	{
+		grid   g = { 0 };
+		record r;
+		int    got;
+		for (u4 index = 0; (got = read_record(in, manifest, index, &r)) > 0; ++index)
 		{
-			fprintf(stderr, "direction is blocked\n");
-			if (debug_mode)
-			{
-				// Calculate current position
-				u4 curr_x = (i - b) % w;
-				u4 curr_y = (i - b) / w;
-				char dir_char = ' ';
-				if (d == delta[0]) dir_char = 'L';
-				else if (d == delta[1]) dir_char = 'U';
-				else if (d == delta[2]) dir_char = 'R';
-				else if (d == delta[3]) dir_char = 'D';
-				fprintf(stderr, "Attempted direction: %c\n", dir_char);
-				print_board_state(b, w, h, curr_x, curr_y);
-			}
-			free(b);
-			if (debug_mode) free(board);
-			return EXIT_FAILURE;
+			check_one(&g, manifest, &r);
+			print_verdict(index, r.ok, r.error, r.report, usage_mode ? &r.used : NULL);
+			record_release(&r);
 		}
-
+		if (got < 0) status = EXIT_FAILURE;
+		grid_release(&g);
+	}
+	else
+	{
+		record* records = NULL;
+		u4      count   = 0;
+		u4      cap     = 0;
 		for (;;)
 		{
-			do
+			if (count == cap)
 			{
-				n -= 1;
-				i += d;
-				*i = 0;
+				cap = cap ? cap * 2 : 64;
+				record* const grown = realloc(records, cap * sizeof(*records));
+				if (!grown)
+				{
+					fprintf(stderr, "out of memory\n");
+					status = EXIT_FAILURE;
+					break;
+				}
+				records = grown;
 			}
-			while (i[d]);
+			int const got = read_record(in, manifest, count, &records[count]);
+			if (got < 0) status = EXIT_FAILURE;
+			if (got <= 0) break;
+			++count;
+		}
+		// Check whatever was read intact, even if the input was cut short.
+		if (check_parallel(records, count, manifest, jobs) != EXIT_SUCCESS) status = EXIT_FAILURE;
+		for (u4 i = 0; i != count; ++i) record_release(&records[i]);
+		free(records);
+	}
 
-			if (!compressed) break;
+	if (in != stdin) fclose(in);
+	return status;
+}
 
-			// Check if there is only one free direction.
-			for (u4 dir = 0;; ++dir)
-			{
-				if (dir == 4) goto decision; // No free neighbours?
-				d = delta[dir];
-				if (!i[d]) continue;
-				// Is the opposite direction free, too?
-				if (dir < 2 && i[delta[dir + 2]]) goto decision;
-				break;
-			}
-		}
-decision:;
+// One of the two solutions of a comparison, decoded on its own copy of the
+// board.
+typedef struct side
+{
+	grid        g;
+	decoder     d;
+	input       in;
+	char const* q;       // Next unread byte.
+	char const* q_end;   // End of the path line.
+	bool        ok;
+} side;
+
+static bool side_open(side* const s, char const* const board, char const* const name, char* const error)
+{
+	u4 n;
+	if (!load_board(&s->g, board, &n, error)) return false;
+	if (!input_open(&s->in, name)) return fail(error, "failed to open solution %s", name);
+	decoder_init(&s->d, &s->g, n);
+
+	// Feed the header a byte at a time, so the path starts at s->q.
+	char const* const end = s->in.data + s->in.size;
+	s->q  = s->in.data;
+	s->ok = true;
+	while (s->ok && s->q != end && s->d.header_eqs != 3) s->ok = decoder_feed(&s->d, s->q++, 1);
+	if (s->ok && s->d.header_eqs != 3) s->ok = decoder_finish(&s->d);
+
+	s->q_end = s->q;
+	while (s->q_end != end && *s->q_end != '\n' && *s->q_end != '\r') ++s->q_end;
+	return true;
+}
+
+// Whether the header was read, so that the walk has a start cell.
+static bool side_started(side const* const s)
+{
+	return s->d.error == DECODE_OK || s->d.error >= DECODE_START_BLOCKED;
+}
+
+static void side_feed(side* const s, char const* const q_end)
+{
+	if (s->ok) s->ok = decoder_feed(&s->d, s->q, q_end - s->q);
+	s->q = q_end;
+}
+
+static void print_position(side const* const s)
+{
+	printf("\"x\":%u,\"y\":%u", s->d.pos % s->g.w - 1, s->d.pos / s->g.w - 1);
+}
+
+// Where a side stood at the divergence and the move it made there, or ""
+// where its path ended.  A side that had already failed has no position, and
+// one without a start is null.
+static void print_divergence(side const* const s)
+{
+	if (!side_started(s))
+	{
+		printf("null");
+		return;
+	}
+	printf("{");
+	if (s->ok) print_position(s), printf(",");
+	printf("\"next\":\"%.*s\"}", s->q != s->q_end ? 1 : 0, s->q);
+}
+
+static void print_outcome(side const* const s)
+{
+	if (s->ok)
+	{
+		printf("{\"ok\":true,\"moves\":%llu}", (unsigned long long)s->d.moves);
+		return;
+	}
+	printf("{\"ok\":false,\"error\":");
+	print_json_string(stdout, s->d.message);
+	if (side_started(s))
+	{
+		printf(",\"move\":%llu,", (unsigned long long)s->d.moves);
+		print_position(s);
 	}
-end_of_path:
-	fclose(g);
+	printf("}");
+}
 
-	if (n != 0)
+// Walk two solutions to the same board side by side.  Both are fed the moves
+// they have in common at once, which leaves them on the same cell with the
+// same cells visited, so only the rest of each path is walked on its own, as
+// far as its first illegal move.  Prints one JSON line with the first move
+// where they differ and the outcome of each, and succeeds if they are the
+// same walk.
+static int compare(char const* const board, char const* const name_a, char const* const name_b)
+{
+	char error[ERROR_SIZE];
+	side a = { 0 };
+	side b = { 0 };
+	// Board dumps would chiefly repeat each other.
+	debug_mode = false;
+	bool ok = side_open(&a, board, name_a, error) && side_open(&b, board, name_b, error);
+	bool const started = ok && side_started(&a) && side_started(&b);
+	if (started && a.d.compressed != b.d.compressed)
 	{
-		fprintf(stderr, "path misses %u fields\n", n);
-		if (debug_mode)
+		ok = fail(error, "cannot compare a path with a qpath");
+	}
+	if (!ok)
+	{
+		fprintf(stderr, "%s\n", error);
+	}
+	else
+	{
+		// Without a start on both they differ at move 0.
+		bool const apart   = !started || a.d.start_x != b.d.start_x || a.d.start_y != b.d.start_y;
+		size_t shared = 0;
+		if (!apart)
 		{
-			// Calculate current position
-			u4 curr_x = (i - b) % w;
-			u4 curr_y = (i - b) / w;
-			print_board_state(b, w, h, curr_x, curr_y);
-			fprintf(stderr, "Remaining unvisited cells: %u\n", n);
+			size_t const limit = a.q_end - a.q < b.q_end - b.q ? a.q_end - a.q : b.q_end - b.q;
+			while (shared != limit && a.q[shared] == b.q[shared]) ++shared;
+			side_feed(&a, a.q + shared);
+			side_feed(&b, b.q + shared);
 		}
-		free(b);
-		if (debug_mode) free(board);
-		return EXIT_FAILURE;
+		bool const same = !apart && a.q == a.q_end && b.q == b.q_end;
+
+		printf("{\"same\":%s,\"diverged\":", same ? "true" : "false");
+		if (same)
+		{
+			printf("null");
+		}
+		else
+		{
+			printf("{\"move\":%zu,\"a\":", shared);
+			print_divergence(&a);
+			printf(",\"b\":");
+			print_divergence(&b);
+			printf("}");
+		}
+
+		side_feed(&a, a.q_end);
+		side_feed(&b, b.q_end);
+		if (a.ok) a.ok = decoder_finish(&a.d);
+		if (b.ok) b.ok = decoder_finish(&b.d);
+		printf(",\"a\":");
+		print_outcome(&a);
+		printf(",\"b\":");
+		print_outcome(&b);
+		printf("}\n");
+		ok = same;
+	}
+
+	input_close(&a.in);
+	input_close(&b.in);
+	grid_release(&a.g);
+	grid_release(&b.g);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int usage(char const* const prog)
+{
+    fprintf(stderr,
+        "Usage: %s [-d] [-r] [-p] [-H] <board filename> <solution filename>\n"
+        "       %s [-d] [-r] [-u] [-p] [-H] [-j <jobs>] -b\n"
+        "       %s [-d] [-r] [-u] [-p] [-H] [-j <jobs>] -m <manifest filename>\n"
+        "       %s [-p] [-H] -c <board filename> <solution filename> <solution filename>\n"
+        "Options:\n"
+        "  -d    Enable debug mode\n"
+        "  -r    Report on the unvisited cells of a failed solution as JSON\n"
+        "  -u    Add the resources each record took to its verdict\n"
+        "  -p    Use the packed grid regardless of board size\n"
+        "  -H    Back the grids with huge pages where available\n"
+        "  -b    Batch mode: check records read from standard input\n"
+        "  -m    Check every board and solution pair listed in a manifest\n"
+        "  -j    Check records on this many threads, 0 for one per CPU\n"
+        "        (reads all records before checking any)\n"
+        "  -c    Compare two solutions: print the first move where they differ and\n"
+        "        where each one fails as JSON, and succeed if they are the same walk\n"
+        "A filename of - reads from standard input.\n"
+        "File formats:\n"
+        "  board:    x=<x>&y=<y>&board=<board>, or <pack filename>:<number> for a\n"
+        "            level of a pack written by pack_levels.py\n"
+        "  solution: x=<x>&y=<y>&path=<path>\n"
+        "            x=<x>&y=<y>&qpath=<qpath>\n"
+        "  batch:    length=<n>&board=<board filename>, a newline, then n bytes\n"
+        "            of solution, repeated; or length=<n>&boardlength=<m>, a\n"
+        "            newline, m bytes of board, then n bytes of solution\n"
+        "  manifest: <board filename><tab><solution filename> per line\n"
+        "Batch and manifest mode print one JSON verdict line per record; with -r a\n"
+        "failed one carries its report.  Otherwise the report goes to standard output.\n",
+        prog, prog, prog, prog);
+    return EXIT_FAILURE;
+}
+
+int main(int const argc, char** const argv)
+{
+    // Parse command line options
+    bool        batch    = false;
+    bool        diff     = false;
+    char const* manifest = NULL;
+    long        jobs     = 1;
+    int opt;
+    while ((opt = getopt(argc, argv, "drupHbcm:j:")) != -1)
+    {
+        switch (opt)
+        {
+            case 'd':
+                debug_mode = true;
+                break;
+            case 'r':
+                report_mode = true;
+                break;
+            case 'u':
+                usage_mode = true;
+                break;
+            case 'p':
+                force_packed = true;
+                break;
+            case 'H':
+                huge_pages = true;
+                break;
+            case 'b':
+                batch = true;
+                break;
+            case 'c':
+                diff = true;
+                break;
+            case 'm':
+                manifest = optarg;
+                break;
+            case 'j':
+                jobs = strtol(optarg, NULL, 10);
+                if (jobs == 0) jobs = sysconf(_SC_NPROCESSORS_ONLN);
+                if (jobs < 1) jobs = 1;
+                break;
+            default:
+                return usage(argv[0]);
+        }
+    }
+
+    // Board dumps from several workers would interleave.
+    if (debug_mode)
+    {
+        jobs = 1;
+    }
+    if (batch)
+    {
+        return run_records("-", false, jobs);
+    }
+    if (manifest)
+    {
+        return run_records(manifest, true, jobs);
+    }
+    if (diff)
+    {
+        if (optind + 3 > argc) return usage(argv[0]);
+        return compare(argv[optind], argv[optind + 1], argv[optind + 2]);
+    }
+
+    // Check if we have the required arguments
+    if (optind + 2 > argc)
+    {
+        return usage(argv[0]);
+    }
+
+	char  error[ERROR_SIZE];
+	char* report = NULL;
+	grid  b      = { 0 };
+	u4    n;
+
+	// Read board.
+	bool ok = load_board(&b, argv[optind], &n, error);
+
+	// Check solution.
+	if (ok)
+	{
+		ok = check_path_file(&b, n, argv[optind + 1], error, &report);
 	}
+	grid_release(&b);
 
-	free(b);
-	if (debug_mode) free(board);
+	if (!ok)
+	{
+		if (!debug_mode) fprintf(stderr, "%s\n", error);
+		if (report) printf("%s\n", report);
+		free(report);
+		return EXIT_FAILURE;
+	}
 	return EXIT_SUCCESS;
 }
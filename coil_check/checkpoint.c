@@ -0,0 +1,166 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "checkpoint.h"
+#include "decode.h"
+#include "input.h"
+
+// Layout, in host byte order: the magic, the version, w, h, free cells, start
+// count and next start as u4s, the board fingerprint and the three counters
+// as u8s, then the walk count and for each walk its start, fixed and depth as
+// u4s followed by its moves at four to a byte, lowest bits first; last the
+// slot count as a u8 and the slots.
+static char const magic[8] = { 'C', 'O', 'I', 'L', 'C', 'K', 'P', 'T' };
+static u4 const   version  = 1;
+
+u8 checkpoint_fingerprint(u1 const* const cells, size_t const size)
+{
+	u8 h = 0xCBF29CE484222325ull;
+	for (size_t i = 0; i != size; ++i) h = (h ^ (cells[i] != 0)) * 0x100000001B3ull;
+	return h;
+}
+
+static bool put(FILE* const f, void const* const data, size_t const size)
+{
+	return fwrite(data, 1, size, f) == size;
+}
+
+static bool put_u4(FILE* const f, u4 const v)
+{
+	return put(f, &v, sizeof(v));
+}
+
+static bool put_u8(FILE* const f, u8 const v)
+{
+	return put(f, &v, sizeof(v));
+}
+
+static bool put_moves(FILE* const f, u1 const* const moves, u4 const depth)
+{
+	u1 packed[256];
+	u4 n = 0;
+	for (u4 m = 0; m < depth; m += 4)
+	{
+		u1 b = 0;
+		for (u4 k = 0; k != 4 && m + k != depth; ++k) b |= moves[m + k] << 2 * k;
+		packed[n++] = b;
+		if (n == sizeof(packed))
+		{
+			if (!put(f, packed, n)) return false;
+			n = 0;
+		}
+	}
+	return put(f, packed, n);
+}
+
+bool checkpoint_write(checkpoint const* const c, char const* const name)
+{
+	size_t const length = strlen(name);
+	char* const  temp   = malloc(length + 5);
+	if (!temp) return false;
+	memcpy(temp, name, length);
+	memcpy(temp + length, ".tmp", 5);
+
+	FILE* const f  = fopen(temp, "wb");
+	bool        ok = f != NULL;
+	ok = ok && put(f, magic, sizeof(magic)) && put_u4(f, version);
+	ok = ok && put_u4(f, c->w) && put_u4(f, c->h) && put_u4(f, c->free_cells);
+	ok = ok && put_u4(f, c->start_count) && put_u4(f, c->next_start);
+	ok = ok && put_u8(f, c->board) && put_u8(f, c->nodes) && put_u8(f, c->hits) && put_u8(f, c->stores);
+	ok = ok && put_u4(f, c->count);
+	for (u4 k = 0; ok && k != c->count; ++k)
+	{
+		checkpoint_walk const* const t = &c->walks[k];
+		ok = put_u4(f, t->start) && put_u4(f, t->fixed) && put_u4(f, t->depth) && put_moves(f, t->moves, t->depth);
+	}
+	u8 const slots = c->slots ? c->slot_count : 0;
+	ok = ok && put_u8(f, slots) && (slots == 0 || put(f, c->slots, slots * sizeof(*c->slots)));
+	if (f && fclose(f) != 0) ok = false;
+	ok = ok && rename(temp, name) == 0;
+	if (!ok) remove(temp);
+	free(temp);
+	return ok;
+}
+
+typedef struct reader
+{
+	u1 const* p;
+	u1 const* end;
+} reader;
+
+static bool get(reader* const r, void* const data, size_t const size)
+{
+	if ((size_t)(r->end - r->p) < size) return false;
+	memcpy(data, r->p, size);
+	r->p += size;
+	return true;
+}
+
+bool checkpoint_read(checkpoint* const c, char const* const name, char* const error)
+{
+	memset(c, 0, sizeof(*c));
+	input f;
+	if (!input_open(&f, name))
+	{
+		snprintf(error, ERROR_SIZE, "failed to open checkpoint");
+		return false;
+	}
+
+	reader r = { (u1 const*)f.data, (u1 const*)f.data + f.size };
+	char   m[sizeof(magic)];
+	u4     v;
+	bool   ok = get(&r, m, sizeof(m)) && memcmp(m, magic, sizeof(m)) == 0 && get(&r, &v, sizeof(v)) && v == version;
+	ok = ok && get(&r, &c->w, 4) && get(&r, &c->h, 4) && get(&r, &c->free_cells, 4);
+	ok = ok && get(&r, &c->start_count, 4) && get(&r, &c->next_start, 4);
+	ok = ok && get(&r, &c->board, 8) && get(&r, &c->nodes, 8) && get(&r, &c->hits, 8) && get(&r, &c->stores, 8);
+	ok = ok && get(&r, &c->count, 4) && c->count <= (size_t)(r.end - r.p) / 12;
+	if (ok)
+	{
+		c->walks = calloc(c->count + 1, sizeof(*c->walks));
+		ok       = c->walks != NULL;
+	}
+	for (u4 k = 0; ok && k != c->count; ++k)
+	{
+		checkpoint_walk* const t = &c->walks[k];
+		ok = get(&r, &t->start, 4) && get(&r, &t->fixed, 4) && get(&r, &t->depth, 4) && t->fixed <= t->depth;
+		ok = ok && t->depth / 4 <= (size_t)(r.end - r.p);
+		if (ok)
+		{
+			t->moves = malloc(t->depth + 1);
+			ok       = t->moves != NULL;
+		}
+		for (u4 m = 0; ok && m < t->depth; m += 4)
+		{
+			u1 b = 0;
+			ok = get(&r, &b, 1);
+			for (u4 n = 0; n != 4 && m + n != t->depth; ++n) t->moves[m + n] = b >> 2 * n & 3;
+		}
+	}
+	ok = ok && get(&r, &c->slot_count, 8) && c->slot_count <= (size_t)(r.end - r.p) / sizeof(u8);
+	if (ok && c->slot_count)
+	{
+		c->loaded = malloc(c->slot_count * sizeof(*c->loaded));
+		ok        = c->loaded && get(&r, c->loaded, c->slot_count * sizeof(*c->loaded));
+		c->slots  = c->loaded;
+	}
+	ok = ok && r.p == r.end;
+	input_close(&f);
+	if (!ok)
+	{
+		snprintf(error, ERROR_SIZE, "invalid checkpoint");
+		checkpoint_free(c);
+	}
+	return ok;
+}
+
+void checkpoint_free(checkpoint* const c)
+{
+	for (u4 k = 0; c->walks && k != c->count; ++k) free(c->walks[k].moves);
+	free(c->walks);
+	free(c->loaded);
+	c->walks  = NULL;
+	c->loaded = NULL;
+	c->slots  = NULL;
+	c->count  = 0;
+}
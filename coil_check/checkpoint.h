@@ -0,0 +1,50 @@
+#ifndef COIL_CHECKPOINT_H
+#define COIL_CHECKPOINT_H
+
+#include "grid.h"
+
+// A walk of the solver's search to pick up again: from start, the first
+// fixed moves are taken as given, and below those the search carries on from
+// each of the remaining moves, skipping the moves before it that it had
+// already tried.
+typedef struct checkpoint_walk
+{
+	u4  start;
+	u4  fixed;
+	u4  depth;
+	u1* moves; // Directions, in the solver's delta order.
+} checkpoint_walk;
+
+// What is left of a search: the walks above, and the start cells from
+// next_start on.  The board is known by its size and fingerprint.  The
+// solver's table of dead states can come along.
+typedef struct checkpoint
+{
+	u4               w;
+	u4               h;
+	u4               free_cells;
+	u4               start_count;
+	u4               next_start;
+	u8               board;
+	u8               nodes;
+	u8               hits;
+	u8               stores;
+	u4               count;
+	checkpoint_walk* walks;
+	u8               slot_count;
+	u8 const*        slots;      // Written straight from the table; may be NULL.
+	u8*              loaded;     // Slots read back, to be freed.
+} checkpoint;
+
+u8 checkpoint_fingerprint(u1 const* cells, size_t size);
+
+// Write the checkpoint to name, by way of a temporary file, so that an
+// earlier checkpoint stays intact until the new one is complete.
+bool checkpoint_write(checkpoint const* c, char const* name);
+
+// Read a checkpoint back.  Returns false and fills error if it cannot.
+bool checkpoint_read(checkpoint* c, char const* name, char* error);
+
+void checkpoint_free(checkpoint* c);
+
+#endif
@@ -0,0 +1,135 @@
+#!/usr/bin/env python3
+"""Resume the solver from damaged checkpoints.
+
+Each case writes a checkpoint for a small level, in the layout described in
+checkpoint.c, and runs `solve -c` on it.  A sound checkpoint has to resume
+and solve the level; a damaged one has to be turned down with "invalid
+checkpoint" before the search starts, rather than crash it.
+"""
+import struct
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+LEVEL = HERE.parent / "levels_public" / "21"
+MAGIC = b"COILCKPT"
+VERSION = 1
+
+
+def parse_level(text):
+    fields = dict(part.split("=", 1) for part in text.strip().split("&"))
+    return int(fields["x"]), int(fields["y"]), fields["board"]
+
+
+def stride(width):
+    """The solver's row stride for a board width, border included."""
+    s = 16
+    while s < width:
+        s *= 2
+    return s
+
+
+class Board:
+    """The level as the solver lays it out: bordered, rows stride apart."""
+
+    def __init__(self, text):
+        width, height, board = parse_level(text)
+        self.width = width + 2
+        self.w = stride(self.width)
+        self.h = height + 2
+        self.cells = bytearray(self.w * self.h)
+        for y in range(height):
+            for x in range(width):
+                if board[y * width + x] == ".":
+                    self.cells[(y + 1) * self.w + x + 1] = 1
+        self.delta = (-1, -self.w, 1, self.w)
+
+    def fingerprint(self):
+        h = 0xCBF29CE484222325
+        for c in self.cells:
+            h = ((h ^ (c != 0)) * 0x100000001B3) & 0xFFFFFFFFFFFFFFFF
+        return h
+
+    def free_cells(self):
+        return sum(self.cells)
+
+    def first_move(self):
+        """A free cell and a direction that leads into a free cell."""
+        for i, c in enumerate(self.cells):
+            for k, d in enumerate(self.delta):
+                if c and self.cells[i + d]:
+                    return i, k
+        raise ValueError("no moves")
+
+    def wall(self):
+        return self.cells.index(0, self.w + 1)
+
+
+def pack_moves(moves):
+    data = bytearray((len(moves) + 3) // 4)
+    for m, k in enumerate(moves):
+        data[m // 4] |= k << 2 * (m % 4)
+    return bytes(data)
+
+
+def checkpoint(board, walks=(), next_start=0):
+    """A checkpoint of the board with the given (start, fixed, moves) walks."""
+    n = board.free_cells()
+    data = MAGIC + struct.pack("=I", VERSION)
+    data += struct.pack("=IIIII", board.width, board.h, n, n, next_start)
+    data += struct.pack("=QQQQ", board.fingerprint(), 0, 0, 0)
+    data += struct.pack("=I", len(walks))
+    for start, fixed, moves in walks:
+        data += struct.pack("=III", start, fixed, len(moves)) + pack_moves(moves)
+    return data + struct.pack("=Q", 0)
+
+
+def resume(solver, data, directory):
+    """Run the solver on a checkpoint; return its exit status and output."""
+    path = Path(directory) / "checkpoint"
+    path.write_bytes(data)
+    result = subprocess.run(
+        [str(solver), "-c", str(path), str(LEVEL)], capture_output=True, text=True, timeout=60
+    )
+    return result.returncode, result.stdout + result.stderr
+
+
+def main():
+    solver = HERE / "solve"
+    board = Board(LEVEL.read_text())
+    start, k = board.first_move()
+    wall = board.wall()
+    blocked = next(j for j, d in enumerate(board.delta) if not board.cells[start + d])
+    n = board.free_cells()
+    sound = checkpoint(board)
+    cases = [
+        ("sound", sound, True),
+        ("sound walk", checkpoint(board, [(start, 1, [k])]), True),
+        ("truncated", sound[:-5], False),
+        ("start off the grid", checkpoint(board, [(board.w * board.h + 7, 0, [])]), False),
+        ("start on a wall", checkpoint(board, [(wall, 0, [])]), False),
+        ("second move blocked", checkpoint(board, [(start, 1, [k, k])]), False),
+        ("first move blocked", checkpoint(board, [(start, 0, [blocked])]), False),
+        ("too deep", checkpoint(board, [(start, 0, [k] * n)]), False),
+        ("fixed below depth", checkpoint(board, [(start, 2, [k])]), False),
+    ]
+
+    failed = 0
+    with tempfile.TemporaryDirectory() as directory:
+        for name, data, good in cases:
+            status, output = resume(solver, data, directory)
+            if good:
+                ok = status == 0 and "qpath=" in output
+            else:
+                ok = status == 1 and "invalid checkpoint" in output
+            print(f"{'ok' if ok else 'FAIL'}: {name}")
+            if not ok:
+                print(f"    exit status {status}: {output.strip()}")
+                failed += 1
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
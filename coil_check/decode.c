@@ -0,0 +1,220 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "decode.h"
+#include "parse.h"
+
+enum
+{
+	STATE_HEADER,
+	STATE_PATH,
+	STATE_ENDED,
+	STATE_FAILED,
+};
+
+static bool fail(decoder* const d, decode_error const error, char const* const fmt, ...)
+{
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(d->message, sizeof(d->message), fmt, args);
+	va_end(args);
+	d->error = error;
+	d->state = STATE_FAILED;
+	return false;
+}
+
+void decoder_init(decoder* const d, grid* const g, u4 const free_cells)
+{
+	memset(d, 0, sizeof(*d));
+	d->g         = g;
+	d->remaining = free_cells;
+	d->delta[0]  = -1;
+	d->delta[1]  = -(s4)g->w;
+	d->delta[2]  = 1;
+	d->delta[3]  = (s4)g->w;
+	d->state     = STATE_HEADER;
+}
+
+// Parse the buffered header and put the walker on its start cell.
+static bool start(decoder* const d)
+{
+	grid* const       b     = d->g;
+	char const*       q     = d->header;
+	char const* const q_end = d->header + d->header_len;
+	u4   start_y;
+	u4   start_x;
+	char path[7];
+	{
+		size_t len = 0;
+		bool const ok =
+			parse_lit(&q, q_end, "x=") && parse_u4(&q, q_end, &start_x) &&
+			parse_lit(&q, q_end, "&y=") && parse_u4(&q, q_end, &start_y) &&
+			parse_lit(&q, q_end, "&");
+		if (ok)
+		{
+			while (q != q_end && *q != '=' && len != sizeof(path) - 1) path[len++] = *q++;
+		}
+		// Like fscanf, accept a solution that ends right after the path type.
+		if (!ok || len == 0 || (q != q_end && *q != '='))
+		{
+			return fail(d, DECODE_BAD_HEADER, "could not parse start position");
+		}
+		path[len] = '\0';
+	}
+
+	if (strcmp(path, "path") == 0)
+	{
+		d->compressed = false;
+	}
+	else if (strcmp(path, "qpath") == 0)
+	{
+		d->compressed = true;
+	}
+	else
+	{
+		return fail(d, DECODE_BAD_TYPE, "did not recognize path type");
+	}
+
+	d->start_x = start_x;
+	d->start_y = start_y;
+	if (start_y >= b->h - 2 || start_x >= b->w - 2)
+	{
+		return fail(d, DECODE_OFF_BOARD, "start position not on board");
+	}
+
+	u4 const i = (start_y + 1) * b->w + start_x + 1;
+	d->pos = i;
+	if (!grid_free(b, i))
+	{
+		return fail(d, DECODE_START_BLOCKED, "start position is blocked");
+	}
+
+	d->remaining -= 1;
+	grid_visit(b, i);
+	d->state = STATE_PATH;
+	return true;
+}
+
+// Walk the moves in [q, q_end).
+static bool walk(decoder* const dec, char const* q, char const* const q_end)
+{
+	grid* const b          = dec->g;
+	s4 const*   delta      = dec->delta;
+	bool const  compressed = dec->compressed;
+	u4          i          = dec->pos;
+	u4          n          = dec->remaining;
+	u8          moves      = dec->moves;
+	slide_hook* on_slide   = dec->on_slide;
+	bool        ok         = true;
+
+	while (q != q_end)
+	{
+		s4 d;
+		switch (*q++)
+		{
+			case 'L': d = delta[0]; break;
+			case 'U': d = delta[1]; break;
+			case 'R': d = delta[2]; break;
+			case 'D': d = delta[3]; break;
+
+			case '\r':
+			case '\n':
+				goto end_of_path;
+
+			default:
+				ok = false;
+				goto out;
+		}
+
+		if (!grid_free(b, i + d))
+		{
+			ok = false;
+			goto out;
+		}
+		++moves;
+
+		for (;;)
+		{
+			u4 const from = i;
+			i = grid_slide(b, i, d, &n);
+			if (on_slide) on_slide(dec->slide_arg, from, i);
+
+			if (!compressed) break;
+
+			// Check if there is only one free direction.
+			for (u4 dir = 0;; ++dir)
+			{
+				if (dir == 4) goto decision; // No free neighbours?
+				d = delta[dir];
+				if (!grid_free(b, i + d)) continue;
+				// Is the opposite direction free, too?
+				if (dir < 2 && grid_free(b, i + delta[dir + 2])) goto decision;
+				break;
+			}
+		}
+decision:;
+	}
+	goto out;
+
+end_of_path:
+	dec->state = STATE_ENDED;
+out:
+	dec->pos       = i;
+	dec->remaining = n;
+	dec->moves     = moves;
+	if (!ok)
+	{
+		char const c = q[-1];
+		if (c == 'L' || c == 'U' || c == 'R' || c == 'D')
+		{
+			dec->attempted = c;
+			return fail(dec, DECODE_BLOCKED, "direction is blocked");
+		}
+		return fail(dec, DECODE_BAD_CHAR, "invalid char in path");
+	}
+	return true;
+}
+
+bool decoder_feed(decoder* const d, char const* data, size_t size)
+{
+	if (d->state == STATE_HEADER)
+	{
+		// Buffer the header up to the '=' after the path type.
+		while (size != 0 && d->header_eqs != 3)
+		{
+			if (d->header_len == sizeof(d->header)) break;
+			char const c = *data++;
+			--size;
+			d->header[d->header_len++] = c;
+			if (c == '=') ++d->header_eqs;
+		}
+		if (d->header_eqs != 3 && d->header_len != sizeof(d->header)) return true;
+		if (!start(d)) return false;
+	}
+
+	switch (d->state)
+	{
+		case STATE_PATH:   return walk(d, data, data + size);
+		case STATE_ENDED:  return true;
+		default:           return false;
+	}
+}
+
+bool decoder_ended(decoder const* const d)
+{
+	return d->state == STATE_ENDED;
+}
+
+bool decoder_finish(decoder* const d)
+{
+	if (d->state == STATE_HEADER && !start(d)) return false;
+	if (d->state == STATE_FAILED) return false;
+
+	d->state = STATE_ENDED;
+	if (d->remaining != 0)
+	{
+		return fail(d, DECODE_INCOMPLETE, "path misses %u fields", d->remaining);
+	}
+	return true;
+}
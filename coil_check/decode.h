@@ -0,0 +1,68 @@
+#ifndef COIL_DECODE_H
+#define COIL_DECODE_H
+
+#include "grid.h"
+
+// Room for an error message.
+#define ERROR_SIZE 64
+
+// Room for the "x=<x>&y=<y>&<type>=" solution header.
+#define HEADER_SIZE 64
+
+typedef enum decode_error
+{
+	DECODE_OK,
+	DECODE_BAD_HEADER,    // could not parse start position
+	DECODE_BAD_TYPE,      // did not recognize path type
+	DECODE_OFF_BOARD,     // start position not on board
+	DECODE_START_BLOCKED, // start position is blocked
+	DECODE_BAD_CHAR,      // invalid char in path
+	DECODE_BLOCKED,       // direction is blocked
+	DECODE_INCOMPLETE,    // path misses <n> fields
+} decode_error;
+
+// Called after every slide of the walk, with the cell it started on and the
+// cell it ended on.
+typedef void slide_hook(void* arg, u4 from, u4 to);
+
+// Incremental solution decoder.  It walks a path or qpath over a grid as the
+// bytes come in, in chunks of any size, so a solution can be checked while it
+// is still being written and rejected at the first bad move.
+typedef struct decoder
+{
+	grid*        g;
+	s4           delta[4];
+	u4           remaining;  // Free cells not visited yet.
+	u4           pos;        // Current cell.
+	u4           start_x;
+	u4           start_y;
+	u8           moves;      // Moves read so far.
+	u1           state;
+	bool         compressed;
+	decode_error error;
+	char         attempted;  // Move that failed with DECODE_BLOCKED.
+	u4           header_len;
+	u4           header_eqs;
+	char         header[HEADER_SIZE];
+	char         message[ERROR_SIZE];
+	slide_hook*  on_slide;   // Set after decoder_init() to follow the walk.
+	void*        slide_arg;
+} decoder;
+
+// Start decoding a solution for the board freshly loaded into g, which has
+// free_cells free cells.
+void decoder_init(decoder* d, grid* g, u4 free_cells);
+
+// Decode the next chunk of the solution.  Returns false as soon as the
+// solution is known to be invalid.  Input after the end of the path line is
+// ignored.
+bool decoder_feed(decoder* d, char const* data, size_t size);
+
+// Whether the path has ended, so that further input would be ignored.
+bool decoder_ended(decoder const* d);
+
+// Finish at the end of the input.  Returns whether the solution visits every
+// free cell.
+bool decoder_finish(decoder* d);
+
+#endif
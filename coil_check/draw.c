@@ -0,0 +1,314 @@
+#define _DEFAULT_SOURCE
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include "decode.h"
+#include "input.h"
+#include "level.h"
+
+// Draw a board, and a solution walked on it, as a PNG.  Each slide of the
+// walk is drawn as one line rather than cell by cell, so even a 2000x2000
+// solution takes little more time than compressing its image.
+
+enum
+{
+	INK_FREE,   // Free cell, or every cell when there is no solution.
+	INK_WALL,
+	INK_LEFT,   // Free cell the solution did not visit.
+	INK_PATH,
+	INK_START,
+	INK_END,
+	INKS,
+};
+
+static u1 const palette[INKS][3] =
+{
+	{ 0xFF, 0xFF, 0xFF },
+	{ 0x33, 0x33, 0x33 },
+	{ 0xF4, 0x43, 0x36 },
+	{ 0x21, 0x96, 0xF3 },
+	{ 0x4C, 0xAF, 0x50 },
+	{ 0xFF, 0x98, 0x00 },
+};
+
+// Images are limited to this many pixels.
+#define MAX_PIXELS (1ull << 30)
+
+// The cells of the board in view, drawn cell by cell pixels each.
+typedef struct image
+{
+	u4  x0;     // First cell in view.
+	u4  y0;
+	u4  cell;   // Pixels per cell.
+	u4  w;      // Size in pixels.
+	u4  h;
+	u1* px;     // One ink per pixel.
+} image;
+
+// Fill the pixels [x0, x1) x [y0, y1), clipped to the image.
+static void fill(image* const im, s4 x0, s4 y0, s4 x1, s4 y1, u1 const ink)
+{
+	if (x0 < 0) x0 = 0;
+	if (y0 < 0) y0 = 0;
+	if (x1 > (s4)im->w) x1 = im->w;
+	if (y1 > (s4)im->h) y1 = im->h;
+	if (x0 >= x1) return;
+	for (s4 y = y0; y < y1; ++y) memset(im->px + (size_t)y * im->w + x0, ink, x1 - x0);
+}
+
+// Draw the centre of the cells from a to b, which share a row or column, of
+// the bordered grid g.  The inset leaves pixels of the cell uncovered on
+// either side.
+static void draw_run(image* const im, grid const* const g, u4 const a, u4 const b, u4 const inset, u1 const ink)
+{
+	u4 const c  = im->cell;
+	u4 const ax = a % g->w - 1, ay = a / g->w - 1;
+	u4 const bx = b % g->w - 1, by = b / g->w - 1;
+	s4 const x0 = ((s4)(ax < bx ? ax : bx) - (s4)im->x0) * (s4)c + inset;
+	s4 const y0 = ((s4)(ay < by ? ay : by) - (s4)im->y0) * (s4)c + inset;
+	s4 const x1 = ((s4)(ax < bx ? bx : ax) - (s4)im->x0 + 1) * (s4)c - inset;
+	s4 const y1 = ((s4)(ay < by ? by : ay) - (s4)im->y0 + 1) * (s4)c - inset;
+	fill(im, x0, y0, x1, y1, ink);
+}
+
+// Draw the walls of the cells in view, and with walked the free cells the
+// walk left, over what is drawn already.  Each run of such cells in a row is
+// one fill.  g has to be loaded in debug mode, to keep the original board.
+static void draw_board(image* const im, grid const* const g, bool const walked)
+{
+	u4 const c     = im->cell;
+	u4 const cells = im->w / c;
+	for (u4 y = 0; y != im->h / c; ++y)
+	{
+		u4 const i = (im->y0 + y + 1) * g->w + im->x0 + 1;
+		u4       x = 0;
+		while (x != cells)
+		{
+			u1 ink = INK_FREE;
+			if (!bit_test(g->orig, i + x)) ink = INK_WALL;
+			else if (walked && grid_free(g, i + x)) ink = INK_LEFT;
+			u4 const x0 = x;
+			for (++x; x != cells; ++x)
+			{
+				u1 next = INK_FREE;
+				if (!bit_test(g->orig, i + x)) next = INK_WALL;
+				else if (walked && grid_free(g, i + x)) next = INK_LEFT;
+				if (next != ink) break;
+			}
+			if (ink != INK_FREE) fill(im, x0 * c, y * c, x * c, (y + 1) * c, ink);
+		}
+	}
+}
+
+// Where the slides of a walk are drawn.
+typedef struct pen
+{
+	image*      im;
+	grid const* g;
+	u4          inset;
+} pen;
+
+static void draw_slide(void* const arg, u4 const from, u4 const to)
+{
+	pen const* const p = arg;
+	draw_run(p->im, p->g, from, to, p->inset, INK_PATH);
+}
+
+// Walk the solution in [q, end) over g with the checker's decoder, drawing
+// each slide as it goes.  The walk stops at the first move the checker would
+// reject, with the checker's error message in error.
+static bool draw_walk(image* const im, grid* const g, u4 const n, char const* const q, char const* const end, char* const error)
+{
+	pen     p = { im, g, im->cell / 3 };
+	decoder d;
+	decoder_init(&d, g, n);
+	d.on_slide  = draw_slide;
+	d.slide_arg = &p;
+	bool const ok = decoder_feed(&d, q, end - q) && decoder_finish(&d);
+	if (!ok) snprintf(error, ERROR_SIZE, "%s", d.message);
+
+	// Mark both ends over the path, once the walk has a start.
+	if (d.error == DECODE_OK || d.error >= DECODE_START_BLOCKED)
+	{
+		u4 const mark  = im->cell / 4;
+		u4 const start = (d.start_y + 1) * g->w + d.start_x + 1;
+		draw_run(im, g, start, start, mark, INK_START);
+		draw_run(im, g, d.pos, d.pos, mark, INK_END);
+	}
+	return ok;
+}
+
+static bool write_chunk(FILE* const out, char const* const type, u1 const* const data, u4 const size)
+{
+	u1 const head[8] = { size >> 24, size >> 16, size >> 8, size, type[0], type[1], type[2], type[3] };
+	uLong crc = crc32(0, head + 4, 4);
+	if (size) crc = crc32(crc, data, size);
+	u1 const tail[4] = { crc >> 24, crc >> 16, crc >> 8, crc };
+	return fwrite(head, 1, 8, out) == 8 && (size == 0 || fwrite(data, 1, size, out) == size) && fwrite(tail, 1, 4, out) == 4;
+}
+
+// Write the image as an 8-bit palette PNG, compressed for speed.
+static bool write_png(FILE* const out, image const* const im)
+{
+	u1 const signature[8] = { 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+	u1 const header[13]   =
+	{
+		im->w >> 24, im->w >> 16, im->w >> 8, im->w,
+		im->h >> 24, im->h >> 16, im->h >> 8, im->h,
+		8, 3, 0, 0, 0,
+	};
+	if (fwrite(signature, 1, 8, out) != 8) return false;
+	if (!write_chunk(out, "IHDR", header, sizeof(header))) return false;
+	if (!write_chunk(out, "PLTE", palette[0], sizeof(palette))) return false;
+
+	z_stream z;
+	memset(&z, 0, sizeof(z));
+	if (deflateInit(&z, Z_BEST_SPEED) != Z_OK) return false;
+	u1* const buf  = malloc(1 << 16);
+	u1* const line = malloc(im->w + 1);
+	bool      ok   = buf && line;
+	if (ok) line[0] = 0; // No filter.
+	for (u4 y = 0; ok && y <= im->h; ++y)
+	{
+		int const flush = y == im->h ? Z_FINISH : Z_NO_FLUSH;
+		if (y != im->h)
+		{
+			memcpy(line + 1, im->px + (size_t)y * im->w, im->w);
+			z.next_in  = line;
+			z.avail_in = im->w + 1;
+		}
+		do
+		{
+			z.next_out  = buf;
+			z.avail_out = 1 << 16;
+			if (deflate(&z, flush) == Z_STREAM_ERROR) ok = false;
+			u4 const size = (1 << 16) - z.avail_out;
+			if (ok && size) ok = write_chunk(out, "IDAT", buf, size);
+		}
+		while (ok && z.avail_out == 0);
+	}
+	deflateEnd(&z);
+	free(buf);
+	free(line);
+	return ok && write_chunk(out, "IEND", NULL, 0);
+}
+
+static int usage(char const* const prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-c <pixels>] [-z <x>,<y>,<w>,<h>] <board filename> [<solution filename>] <png filename>\n"
+		"Options:\n"
+		"  -c    Pixels per cell (default: as many as fit 4000 pixels, up to 16)\n"
+		"  -z    Draw only the w by h cells from column x, row y\n"
+		"A png filename of - writes to standard output, and a solution filename of\n"
+		"- reads from standard input.\n",
+		prog);
+	return EXIT_FAILURE;
+}
+
+int main(int const argc, char** const argv)
+{
+	u4   cell = 0;
+	u4   zoom[4];
+	bool zoomed = false;
+	int  opt;
+	while ((opt = getopt(argc, argv, "c:z:")) != -1)
+	{
+		switch (opt)
+		{
+			case 'c':
+				cell = strtoul(optarg, NULL, 10);
+				if (cell == 0) return usage(argv[0]);
+				break;
+			case 'z':
+				if (sscanf(optarg, "%u,%u,%u,%u", &zoom[0], &zoom[1], &zoom[2], &zoom[3]) != 4) return usage(argv[0]);
+				zoomed = true;
+				break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+	if (argc - optind != 2 && argc - optind != 3) return usage(argv[0]);
+	char const* const board    = argv[optind];
+	char const* const solution = argc - optind == 3 ? argv[optind + 1] : NULL;
+	char const* const name     = argv[argc - 1];
+
+	char error[ERROR_SIZE];
+	grid g = { 0 };
+	u4   n;
+	if (!level_read(&g, board, LAYOUT_AUTO, true, &n, error))
+	{
+		fprintf(stderr, "%s\n", error);
+		return EXIT_FAILURE;
+	}
+
+	// The view, clipped to the board.
+	image im = { 0, 0, 0, g.w - 2, g.h - 2, NULL };
+	if (zoomed)
+	{
+		im.x0 = zoom[0] < im.w ? zoom[0] : im.w;
+		im.y0 = zoom[1] < im.h ? zoom[1] : im.h;
+		im.w  = zoom[2] < im.w - im.x0 ? zoom[2] : im.w - im.x0;
+		im.h  = zoom[3] < im.h - im.y0 ? zoom[3] : im.h - im.y0;
+	}
+	if (im.w == 0 || im.h == 0)
+	{
+		fprintf(stderr, "nothing in view\n");
+		grid_release(&g);
+		return EXIT_FAILURE;
+	}
+	if (cell == 0)
+	{
+		u4 const side = im.w > im.h ? im.w : im.h;
+		cell = side < 4000 ? 4000 / side : 1;
+		if (cell > 16) cell = 16;
+	}
+	if ((u8)im.w * im.h > MAX_PIXELS / ((u8)cell * cell))
+	{
+		fprintf(stderr, "image too large\n");
+		grid_release(&g);
+		return EXIT_FAILURE;
+	}
+	im.cell = cell;
+	im.w   *= cell;
+	im.h   *= cell;
+	im.px   = malloc((size_t)im.w * im.h);
+	if (!im.px)
+	{
+		fprintf(stderr, "out of memory\n");
+		grid_release(&g);
+		return EXIT_FAILURE;
+	}
+
+	// The walk goes first, so the board can show the cells it left.
+	bool ok = true;
+	memset(im.px, INK_FREE, (size_t)im.w * im.h);
+	if (solution)
+	{
+		input in;
+		ok = input_open(&in, solution);
+		if (!ok) snprintf(error, ERROR_SIZE, "failed to open solution");
+		else     ok = draw_walk(&im, &g, n, in.data, in.data + in.size, error);
+		if (!ok) fprintf(stderr, "%s\n", error);
+		input_close(&in);
+	}
+	draw_board(&im, &g, solution != NULL);
+	grid_release(&g);
+
+	FILE* const out   = strcmp(name, "-") == 0 ? stdout : fopen(name, "wb");
+	bool        wrote = out && write_png(out, &im);
+	if (out && out != stdout) wrote = fclose(out) == 0 && wrote;
+	else if (out)             wrote = fflush(out) == 0 && wrote;
+	free(im.px);
+	if (!wrote)
+	{
+		fprintf(stderr, "failed to write %s\n", name);
+		return EXIT_FAILURE;
+	}
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
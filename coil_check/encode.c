@@ -0,0 +1,32 @@
+#include "encode.h"
+
+char const move_char[4] = { 'L', 'U', 'R', 'D' };
+
+bool encode_qpath(u1* const cells, s4 const delta[4], u4 const start, u1 const* const moves, u4 const count, char* const out, u4* const len)
+{
+	u4 i = start;
+	u4 n = 0;
+	cells[i] = 0;
+	for (u4 m = 0; m != count; ++m)
+	{
+		u1 const dir  = moves[m];
+		bool     emit = true;
+		if (m != 0)
+		{
+			// The checker's rule for a move it makes by itself.
+			for (u1 k = 0; k != 4; ++k)
+			{
+				if (!cells[i + delta[k]]) continue;
+				if (k < 2 && cells[i + delta[k + 2]]) break;
+				if (k != dir) return false;
+				emit = false;
+				break;
+			}
+		}
+		if (emit) out[n++] = move_char[dir];
+		s4 const d = delta[dir];
+		while (cells[i + d]) cells[i += d] = 0;
+	}
+	*len = n;
+	return true;
+}
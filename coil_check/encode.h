@@ -0,0 +1,18 @@
+#ifndef COIL_ENCODE_H
+#define COIL_ENCODE_H
+
+#include "grid.h"
+
+// Letters of the moves, in the L, U, R, D order of the checker's deltas.
+extern char const move_char[4];
+
+// Write the walk from cell start, sliding in directions moves[0..count), as
+// the moves of a qpath: those the checker makes by itself are left out.  The
+// walk is replayed on cells, a bordered byte grid where non-zero is free and
+// delta gives the neighbours in L, U, R, D order; the cells it visits are
+// cleared.  out needs room for count moves; the length written is stored in
+// len.  Returns false if the walk cannot be written as a qpath, because the
+// checker would carry on by itself in another direction somewhere.
+bool encode_qpath(u1* cells, s4 const delta[4], u4 start, u1 const* moves, u4 count, char* out, u4* len);
+
+#endif
@@ -0,0 +1,257 @@
+#define _DEFAULT_SOURCE
+
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#include "grid.h"
+
+#define ARENA_ALIGN 64
+#define HUGE_PAGE   (2u << 20)
+
+bool huge_pages = false;
+
+// Make room for size zeroed bytes and drop whatever was handed out before.
+static bool arena_reset(arena* const a, size_t const size)
+{
+	if (size > a->cap)
+	{
+		if (a->base) munmap(a->base, a->cap);
+		a->base  = NULL;
+		a->cap   = 0;
+		a->dirty = 0;
+
+		size_t const page = huge_pages ? HUGE_PAGE : (size_t)sysconf(_SC_PAGESIZE);
+		size_t const cap  = (size + page - 1) / page * page;
+		void*        base = MAP_FAILED;
+#ifdef MAP_HUGETLB
+		if (huge_pages)
+		{
+			base = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		}
+#endif
+		if (base == MAP_FAILED)
+		{
+			// No reserved huge pages; settle for transparent ones.
+			base = mmap(NULL, cap, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+			if (base == MAP_FAILED) return false;
+#ifdef MADV_HUGEPAGE
+			if (huge_pages) madvise(base, cap, MADV_HUGEPAGE);
+#endif
+		}
+		a->base = base;
+		a->cap  = cap;
+	}
+	memset(a->base, 0, size < a->dirty ? size : a->dirty);
+	if (size > a->dirty) a->dirty = size;
+	a->used = 0;
+	return true;
+}
+
+static void* arena_take(arena* const a, size_t const size)
+{
+	void* const p = a->base + a->used;
+	a->used += (size + ARENA_ALIGN - 1) / ARENA_ALIGN * ARENA_ALIGN;
+	return p;
+}
+
+static void arena_release(arena* const a)
+{
+	if (a->base) munmap(a->base, a->cap);
+	memset(a, 0, sizeof(*a));
+}
+
+static u8 const ONES = 0x0101010101010101ull;
+
+// Clear bits lo to hi inclusive.
+static void bits_clear_range(u8* const b, u4 const lo, u4 const hi)
+{
+	u4 const first = lo >> 6;
+	u4 const last  = hi >> 6;
+	u8 const lo_mask = ~0ull << (lo & 63);
+	u8 const hi_mask = ~0ull >> (63 - (hi & 63));
+	if (first == last)
+	{
+		b[first] &= ~(lo_mask & hi_mask);
+		return;
+	}
+	b[first] &= ~lo_mask;
+	for (u4 k = first + 1; k != last; ++k) b[k] = 0;
+	b[last] &= ~hi_mask;
+}
+
+// Number of consecutive set bits from bit j upwards.
+static inline u4 bits_run_up(u8 const* const b, u4 j)
+{
+	u4 run = 0;
+	for (;;)
+	{
+		u8 const stop = ~b[j >> 6] >> (j & 63);
+		if (stop) return run + __builtin_ctzll(stop);
+		u4 const step = 64 - (j & 63);
+		run += step;
+		j   += step;
+	}
+}
+
+// Number of consecutive set bits from bit j downwards.
+static inline u4 bits_run_down(u8 const* const b, u4 j)
+{
+	u4 run = 0;
+	for (;;)
+	{
+		u8 const stop = ~b[j >> 6] << (63 - (j & 63));
+		if (stop) return run + __builtin_clzll(stop);
+		u4 const step = (j & 63) + 1;
+		run += step;
+		j   -= step;
+	}
+}
+
+// Load eight cells so that the lowest address ends up in the low byte.
+static inline u8 load_cells(u1 const* const p)
+{
+	u8 v;
+	memcpy(&v, p, sizeof(v));
+#if defined __BYTE_ORDER__ && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+	v = __builtin_bswap64(v);
+#endif
+	return v;
+}
+
+// Number of consecutive free cells from p upwards.  Cells are 0 or 1, so the
+// free ones mask the low bit of each byte.
+static inline u4 bytes_run_up(u1 const* p)
+{
+	for (u4 run = 0;; run += 8, p += 8)
+	{
+		u8 const stop = ~load_cells(p) & ONES;
+		if (stop) return run + (__builtin_ctzll(stop) >> 3);
+	}
+}
+
+// Number of consecutive free cells from p downwards.
+static inline u4 bytes_run_down(u1 const* p)
+{
+	for (u4 run = 0;; run += 8, p -= 8)
+	{
+		u8 const stop = ~load_cells(p - 7) & ONES;
+		if (stop) return run + (__builtin_clzll(stop) >> 3);
+	}
+}
+
+bool grid_prepare(grid* const g, u4 const w, u4 const h, bool const packed, bool const debug)
+{
+	u4     const cells = w * h;
+	size_t const words = (cells / 64 + 1) * sizeof(u8);
+	size_t const bytes = packed ? words : cells + 2 * GRID_PAD;
+	size_t const round = ARENA_ALIGN - 1;
+	size_t const size  = (bytes + round) / ARENA_ALIGN * ARENA_ALIGN +
+		(!packed + debug) * ((words + round) / ARENA_ALIGN * ARENA_ALIGN);
+	if (!arena_reset(&g->mem, size)) return false;
+
+	g->w = w;
+	g->h = h;
+	if (packed)
+	{
+		g->bits  = arena_take(&g->mem, words);
+		g->cells = NULL;
+		g->cols  = NULL;
+	}
+	else
+	{
+		g->cells = (u1*)arena_take(&g->mem, bytes) + GRID_PAD;
+		g->bits  = NULL;
+		g->cols  = arena_take(&g->mem, words);
+	}
+	g->orig = debug ? arena_take(&g->mem, words) : NULL;
+	return true;
+}
+
+void grid_release(grid* const g)
+{
+	arena_release(&g->mem);
+	memset(g, 0, sizeof(*g));
+}
+
+// Slide from cell i in direction d until blocked, marking the cells visited.
+// The first step must be free.  The length of a horizontal run is found a
+// word at a time on the row-major grid.  On the byte grid so is a vertical
+// one, on the transposed bitset; the run is cleared in bulk there and cell by
+// cell in the other view.  The packed grid has no transposed copy, so its
+// vertical runs are walked a cell at a time.  Returns the cell the slide ends
+// on.
+u4 grid_slide(grid* const g, u4 const i, s4 const d, u4* const remaining)
+{
+	u4 const h = g->h;
+	u4 const t = grid_col(g, i);
+	u4       run;
+	if (d == 1 || d == -1)
+	{
+		if (g->cells)
+		{
+			u1* const b = g->cells;
+			if (d > 0)
+			{
+				run = bytes_run_up(b + i + 1);
+				memset(b + i + 1, 0, run);
+			}
+			else
+			{
+				run = bytes_run_down(b + i - 1);
+				memset(b + i - run, 0, run);
+			}
+		}
+		else
+		{
+			run = d > 0 ? bits_run_up(g->bits, i + 1) : bits_run_down(g->bits, i - 1);
+			if (d > 0) bits_clear_range(g->bits, i + 1, i + run);
+			else       bits_clear_range(g->bits, i - run, i - 1);
+			*remaining -= run;
+			return i + d * (s4)run;
+		}
+		u8* const cols = g->cols;
+		s4  const step = d * (s4)h;
+		u4        c    = t;
+		for (u4 k = run; k != 0; --k)
+		{
+			c += step;
+			bit_clear(cols, c);
+		}
+	}
+	else if (!g->cells)
+	{
+		u8* const b = g->bits;
+		u4        c = i;
+		run = 0;
+		while (bit_test(b, c + d))
+		{
+			c += d;
+			bit_clear(b, c);
+			++run;
+		}
+	}
+	else
+	{
+		u8* const cols = g->cols;
+		if (d > 0)
+		{
+			run = bits_run_up(cols, t + 1);
+			bits_clear_range(cols, t + 1, t + run);
+		}
+		else
+		{
+			run = bits_run_down(cols, t - 1);
+			bits_clear_range(cols, t - run, t - 1);
+		}
+		u1* const b = g->cells;
+		u4        c = i;
+		for (u4 k = run; k != 0; --k)
+		{
+			c += d;
+			b[c] = 0;
+		}
+	}
+	*remaining -= run;
+	return i + d * (s4)run;
+}
@@ -0,0 +1,98 @@
+#ifndef COIL_GRID_H
+#define COIL_GRID_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef unsigned char u1;
+typedef   signed int  s4;
+typedef unsigned int  u4;
+typedef unsigned long long u8;
+
+// Boards with more cells than this are checked on a bitset.
+#define PACKED_THRESHOLD (1u << 20)
+
+// Backing store for the grids of one worker.  It is a single mapping that
+// only grows to the largest board seen so far.  Between boards just the part
+// that has been written to is zeroed again; the rest still holds the kernel's
+// zero pages.
+typedef struct arena
+{
+	u1*    base;
+	size_t cap;
+	size_t used;  // Handed out for the current board.
+	size_t dirty; // Possibly non-zero prefix.
+} arena;
+
+// Ask for huge pages to back the arenas.
+extern bool huge_pages;
+
+// Occupancy grid with a blocked border.  A non-zero byte or a set bit marks a
+// free cell.  Small boards use a byte per cell and keep a transposed bitset
+// (bit x * h + y) alongside, so that vertical runs are contiguous bits, too.
+// Large ones use one bit per cell and nothing else.
+typedef struct grid
+{
+	u4  w;
+	u4  h;
+	u1* cells; // Byte grid, or NULL if packed.
+	u8* bits;  // Packed grid, if cells is NULL.
+	u8* cols;  // Transposed bitset, with the byte grid only.
+	u8* orig;  // Packed copy of the original board, debug mode only.
+
+	arena mem; // Backing storage, kept between boards.
+} grid;
+
+// Slack around the byte grid, so word loads near the border stay in bounds.
+#define GRID_PAD 8
+
+static inline bool bit_test(u8 const* const b, u4 const i)
+{
+	return b[i >> 6] >> (i & 63) & 1;
+}
+
+static inline void bit_set(u8* const b, u4 const i)
+{
+	b[i >> 6] |= 1ull << (i & 63);
+}
+
+static inline void bit_clear(u8* const b, u4 const i)
+{
+	b[i >> 6] &= ~(1ull << (i & 63));
+}
+
+static inline bool grid_free(grid const* const g, u4 const i)
+{
+	return g->cells ? g->cells[i] != 0 : bit_test(g->bits, i);
+}
+
+static inline u4 grid_col(grid const* const g, u4 const i)
+{
+	return i % g->w * g->h + i / g->w;
+}
+
+// Mark a cell of the original board as free.
+static inline void grid_open(grid* const g, u4 const i)
+{
+	if (g->cells) g->cells[i] = 1;
+	else          bit_set(g->bits, i);
+	if (g->cols)  bit_set(g->cols, grid_col(g, i));
+	if (g->orig)  bit_set(g->orig, i);
+}
+
+static inline void grid_visit(grid* const g, u4 const i)
+{
+	if (g->cells) g->cells[i] = 0;
+	else          bit_clear(g->bits, i);
+	if (g->cols)  bit_clear(g->cols, grid_col(g, i));
+}
+
+// Set the grid up for a board of w by h cells, border included, with every
+// cell blocked.
+bool grid_prepare(grid* g, u4 w, u4 h, bool packed, bool debug);
+
+void grid_release(grid* g);
+
+u4 grid_slide(grid* g, u4 i, s4 d, u4* remaining);
+
+#endif
@@ -0,0 +1,75 @@
+#define _DEFAULT_SOURCE
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#include "input.h"
+
+bool input_open(input* const in, char const* const name)
+{
+	in->data = NULL;
+	in->size = 0;
+	in->map  = NULL;
+	in->buf  = NULL;
+
+	int const fd = strcmp(name, "-") == 0 ? STDIN_FILENO : open(name, O_RDONLY);
+	if (fd < 0) return false;
+
+	struct stat st;
+	if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+	{
+		void* const map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+		if (map != MAP_FAILED)
+		{
+			posix_madvise(map, st.st_size, POSIX_MADV_SEQUENTIAL);
+			in->map  = map;
+			in->data = map;
+			in->size = st.st_size;
+			if (fd != STDIN_FILENO) close(fd);
+			return true;
+		}
+	}
+
+	// Streaming fallback.
+	size_t cap = 1 << 16;
+	size_t len = 0;
+	char*  buf = malloc(cap);
+	for (;;)
+	{
+		if (!buf) goto fail;
+		ssize_t const r = read(fd, buf + len, cap - len);
+		if (r < 0) goto fail;
+		if (r == 0) break;
+		len += r;
+		if (len == cap)
+		{
+			char* const grown = realloc(buf, cap *= 2);
+			if (!grown) goto fail;
+			buf = grown;
+		}
+	}
+	if (fd != STDIN_FILENO) close(fd);
+	in->buf  = buf;
+	in->data = buf;
+	in->size = len;
+	return true;
+
+fail:
+	free(buf);
+	if (fd != STDIN_FILENO) close(fd);
+	in->data = NULL;
+	return false;
+}
+
+void input_close(input* const in)
+{
+	if (in->map) munmap(in->map, in->size);
+	free(in->buf);
+	in->data = NULL;
+	in->map  = NULL;
+	in->buf  = NULL;
+}
@@ -0,0 +1,22 @@
+#ifndef COIL_INPUT_H
+#define COIL_INPUT_H
+
+#include <stddef.h>
+#include <stdbool.h>
+
+// Contents of an input file.  Regular files are mapped, anything else (pipes,
+// terminals, "-" for stdin) is streamed into a heap buffer.
+typedef struct input
+{
+	char const* data;
+	size_t      size;
+	void*       map;
+	char*       buf;
+} input;
+
+// Read the named file, or standard input for "-".
+bool input_open(input* in, char const* name);
+
+void input_close(input* in);
+
+#endif
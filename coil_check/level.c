@@ -0,0 +1,199 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "decode.h"
+#include "input.h"
+#include "level.h"
+#include "parse.h"
+
+bool level_load(grid* const g, char const* p, char const* const end, level_layout const layout, bool const debug, u4* const n, char* const error)
+{
+	u4 board_w;
+	u4 board_h;
+	if (!parse_lit(&p, end, "x=") || !parse_u4(&p, end, &board_w) ||
+			!parse_lit(&p, end, "&y=") || !parse_u4(&p, end, &board_h) ||
+			!parse_lit(&p, end, "&board="))
+	{
+		snprintf(error, ERROR_SIZE, "could not parse board size");
+		return false;
+	}
+	if ((u8)(board_w + 2ull) * (board_h + 2ull) > 0xFFFFFFFFull)
+	{
+		snprintf(error, ERROR_SIZE, "board too large");
+		return false;
+	}
+
+	// Add a blocked border.
+	u4 const h = board_h + 2;
+	u4 const w = board_w + 2;
+	bool const packed = layout == LAYOUT_PACKED || (layout == LAYOUT_AUTO && h * w > PACKED_THRESHOLD);
+	if (!grid_prepare(g, w, h, packed, debug))
+	{
+		snprintf(error, ERROR_SIZE, "out of memory");
+		return false;
+	}
+
+	u4 free_cells = 0;
+	for (u4 y = 1; y != h - 1; ++y)
+	{
+		for (u4 x = 1; x != w - 1; ++x)
+		{
+			if (p == end)
+			{
+				snprintf(error, ERROR_SIZE, "board too short");
+				return false;
+			}
+
+			switch (*p++)
+			{
+				case 'X':                                     break;
+				case '.': grid_open(g, y * w + x); ++free_cells; break;
+
+				default:
+					snprintf(error, ERROR_SIZE, "invalid board char at %ux%u", y - 1, x - 1);
+					return false;
+			}
+		}
+	}
+
+	*n = free_cells;
+	return true;
+}
+
+// A level pack, little-endian throughout: the magic and then the version and
+// the number of index entries as u4s.  Entry k describes level k as a u8
+// offset from the start of the file and the board's width and height as u4s,
+// all zero if the pack has no such level.  Each board is its cells in row
+// order, one bit per cell and set for a wall, lowest bits first.
+static char const pack_magic[8] = { 'C', 'O', 'I', 'L', 'P', 'A', 'C', 'K' };
+static u4 const   pack_version  = 1;
+
+static bool is_pack(char const* const p, char const* const end)
+{
+	return (size_t)(end - p) >= sizeof(pack_magic) && memcmp(p, pack_magic, sizeof(pack_magic)) == 0;
+}
+
+bool level_unpack(grid* const g, char const* const p, char const* const end, u4 const number, level_layout const layout, bool const debug, u4* const n, char* const error)
+{
+	size_t const size = end - p;
+	u4           version;
+	u4           count;
+	if (!is_pack(p, end) || size < 16)
+	{
+		snprintf(error, ERROR_SIZE, "invalid level pack");
+		return false;
+	}
+	memcpy(&version, p + 8, 4);
+	memcpy(&count, p + 12, 4);
+	if (version != pack_version || (size - 16) / 16 < count)
+	{
+		snprintf(error, ERROR_SIZE, "invalid level pack");
+		return false;
+	}
+
+	u8 offset  = 0;
+	u4 board_w = 0;
+	u4 board_h = 0;
+	if (number < count)
+	{
+		char const* const entry = p + 16 + (size_t)number * 16;
+		memcpy(&offset, entry, 8);
+		memcpy(&board_w, entry + 8, 4);
+		memcpy(&board_h, entry + 12, 4);
+	}
+	if (board_w == 0 || board_h == 0)
+	{
+		snprintf(error, ERROR_SIZE, "no level %u in pack", number);
+		return false;
+	}
+	u8 const cells = (u8)board_w * board_h;
+	if ((u8)(board_w + 2ull) * (board_h + 2ull) > 0xFFFFFFFFull || offset > size || (size - offset) * 8 < cells)
+	{
+		snprintf(error, ERROR_SIZE, "invalid level pack");
+		return false;
+	}
+
+	// Add a blocked border.
+	u4 const h = board_h + 2;
+	u4 const w = board_w + 2;
+	bool const packed = layout == LAYOUT_PACKED || (layout == LAYOUT_AUTO && h * w > PACKED_THRESHOLD);
+	if (!grid_prepare(g, w, h, packed, debug))
+	{
+		snprintf(error, ERROR_SIZE, "out of memory");
+		return false;
+	}
+
+	u1 const* const walls      = (u1 const*)p + offset;
+	u4              free_cells = 0;
+	u8              c          = 0;
+	for (u4 y = 1; y != h - 1; ++y)
+	{
+		for (u4 x = 1; x != w - 1; ++x, ++c)
+		{
+			if (walls[c >> 3] >> (c & 7) & 1) continue;
+			grid_open(g, y * w + x);
+			++free_cells;
+		}
+	}
+
+	*n = free_cells;
+	return true;
+}
+
+// Open the first length bytes of spec as a file name.
+static bool open_prefix(input* const f, char const* const spec, size_t const length)
+{
+	char* const name = malloc(length + 1);
+	if (!name) return false;
+	memcpy(name, spec, length);
+	name[length] = '\0';
+	bool const ok = input_open(f, name);
+	free(name);
+	return ok;
+}
+
+bool level_read(grid* const g, char const* const spec, level_layout const layout, bool const debug, u4* const n, char* const error)
+{
+	// A trailing ":<number>" picks a level out of a pack, if what comes before
+	// it is one.  Otherwise spec names a file, colon and all.
+	char const* const colon   = strrchr(spec, ':');
+	bool              indexed = colon && colon != spec && colon[1] != '\0' && strspn(colon + 1, "0123456789") == strlen(colon + 1);
+	input             f;
+	bool              ok      = false;
+	bool              prefix  = false; // The part before the colon opened, but as no pack.
+	if (indexed)
+	{
+		ok = open_prefix(&f, spec, colon - spec);
+		if (ok && !is_pack(f.data, f.data + f.size))
+		{
+			input_close(&f);
+			prefix  = true;
+			ok      = false;
+		}
+		indexed = ok;
+	}
+	if (!ok) ok = input_open(&f, spec);
+	if (!ok)
+	{
+		snprintf(error, ERROR_SIZE, prefix ? "not a level pack" : "failed to open board");
+		return false;
+	}
+	char const* const end = f.data + f.size;
+	if (indexed)
+	{
+		unsigned long const number = strtoul(colon + 1, NULL, 10);
+		ok = level_unpack(g, f.data, end, number > 0xFFFFFFFFul ? 0xFFFFFFFFu : number, layout, debug, n, error);
+	}
+	else if (is_pack(f.data, end))
+	{
+		snprintf(error, ERROR_SIZE, "no level number given for pack");
+		ok = false;
+	}
+	else
+	{
+		ok = level_load(g, f.data, end, layout, debug, n, error);
+	}
+	input_close(&f);
+	return ok;
+}
@@ -0,0 +1,26 @@
+#ifndef COIL_LEVEL_H
+#define COIL_LEVEL_H
+
+#include "grid.h"
+
+// How level_load() lays a board out.
+typedef enum level_layout
+{
+	LAYOUT_AUTO,   // Bytes up to PACKED_THRESHOLD cells, bits above.
+	LAYOUT_PACKED, // Always bits.
+	LAYOUT_BYTES,  // Always bytes.
+} level_layout;
+
+// Parse a board "x=<x>&y=<y>&board=<board>" into g, adding a blocked border.
+// On success the number of free cells is stored in n; otherwise an error
+// message of up to ERROR_SIZE bytes is stored in error.
+bool level_load(grid* g, char const* p, char const* end, level_layout layout, bool debug, u4* n, char* error);
+
+// Unpack level number of a level pack in [p, end) into g, as level_load().
+bool level_unpack(grid* g, char const* p, char const* end, u4 number, level_layout layout, bool debug, u4* n, char* error);
+
+// Load the level named by spec into g, as level_load(): a level file, or
+// "<file>:<number>" for a level in a pack.
+bool level_read(grid* g, char const* spec, level_layout layout, bool debug, u4* n, char* error);
+
+#endif
@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""Name boards the ways the checker accepts them.
+
+A board is a level file, or `<pack>:<number>` for a level of a pack written
+by pack_levels.py.  A level file whose own name ends in `:<number>` is still
+a level file, and a number after anything but a pack is an error.
+"""
+import shutil
+import subprocess
+import sys
+import tempfile
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+ROOT = HERE.parent
+LEVEL = ROOT / "levels_public" / "21"
+SOLUTION = "x=10&y=8&qpath=URDU\n"
+
+
+def check(board, directory):
+    """Check the level's solution on the named board; return status and output."""
+    result = subprocess.run(
+        [str(HERE / "check"), board, "-"], input=SOLUTION, capture_output=True, text=True, cwd=directory, timeout=60
+    )
+    return result.returncode, (result.stdout + result.stderr).strip()
+
+
+def main():
+    with tempfile.TemporaryDirectory() as directory:
+        shutil.copy(LEVEL, Path(directory) / "run:3")
+        shutil.copy(LEVEL, Path(directory) / "plain")
+        subprocess.run(
+            [sys.executable, str(ROOT / "pack_levels.py"), str(LEVEL.parent), str(Path(directory) / "levels.pack")],
+            check=True,
+            capture_output=True,
+        )
+        cases = [
+            ("level file named like a pack level", "run:3", ""),
+            ("level of a pack", "levels.pack:21", ""),
+            ("number after a level file", "plain:3", "not a level pack"),
+            ("pack without a number", "levels.pack", "no level number given for pack"),
+            ("missing file", "missing:3", "failed to open board"),
+        ]
+
+        failed = 0
+        for name, board, error in cases:
+            status, output = check(board, directory)
+            ok = status == 0 if not error else status == 1 and output == error
+            print(f"{'ok' if ok else 'FAIL'}: {name}")
+            if not ok:
+                print(f"    exit status {status}: {output}")
+                failed += 1
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
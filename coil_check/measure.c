@@ -0,0 +1,73 @@
+#define _GNU_SOURCE
+
+#include <errno.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/prctl.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+
+// Run a command and write its peak RSS in kB to a file descriptor.
+//
+// Linux starts a child's ru_maxrss from the RSS of the process that forked
+// it and carries it across exec, and a zombie no longer has the VmHWM of its
+// own memory.  So a harness that has grown large cannot tell how much a small
+// child used.  Started from it, this stays small, forks the command, and
+// passes on what wait4() says about it.  It exits as the command did, and
+// takes the command with it if it is killed first.
+
+static int usage(char const* const prog)
+{
+	fprintf(stderr, "Usage: %s <fd> <command> [<argument>...]\n", prog);
+	return EXIT_FAILURE;
+}
+
+int main(int const argc, char** const argv)
+{
+	if (argc < 3) return usage(argv[0]);
+	char*      end;
+	long const fd = strtol(argv[1], &end, 10);
+	if (*end || end == argv[1] || fd < 0 || fcntl(fd, F_SETFD, FD_CLOEXEC) == -1) return usage(argv[0]);
+
+	pid_t const parent = getpid();
+	pid_t const child  = fork();
+	if (child == -1)
+	{
+		fprintf(stderr, "failed to start %s\n", argv[2]);
+		return EXIT_FAILURE;
+	}
+	if (child == 0)
+	{
+		prctl(PR_SET_PDEATHSIG, SIGKILL);
+		if (getppid() != parent) _exit(EXIT_FAILURE);
+		execvp(argv[2], argv + 2);
+		fprintf(stderr, "failed to run %s: %s\n", argv[2], strerror(errno));
+		_exit(127);
+	}
+
+	int           status;
+	struct rusage used;
+	while (wait4(child, &status, 0, &used) == -1)
+	{
+		if (errno != EINTR)
+		{
+			fprintf(stderr, "failed to wait for %s\n", argv[2]);
+			return EXIT_FAILURE;
+		}
+	}
+	dprintf(fd, "%ld\n", used.ru_maxrss);
+	close(fd);
+
+	if (WIFEXITED(status)) return WEXITSTATUS(status);
+
+	// Die of the same signal, without a second core dump.
+	struct rlimit const none = { 0, 0 };
+	setrlimit(RLIMIT_CORE, &none);
+	signal(WTERMSIG(status), SIG_DFL);
+	raise(WTERMSIG(status));
+	return EXIT_FAILURE;
+}
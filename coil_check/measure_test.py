@@ -0,0 +1,70 @@
+#!/usr/bin/env python3
+"""Measure small runs from a large harness.
+
+Linux starts a child's ru_maxrss at the RSS of the process that forked it.
+The harness here holds a few hundred MB, and a solver or checker run on a
+tiny level has to come out at its own few MB all the same, whether it is run
+to completion or pipelined into the checker.  A run that overstays its
+timeout has to be killed, command and all.
+"""
+import os
+import subprocess
+import sys
+import threading
+from pathlib import Path
+
+HERE = Path(__file__).resolve().parent
+ROOT = HERE.parent
+LEVEL = ROOT / "levels_public" / "1"
+BALLAST_MB = 256
+SMALL_KB = 32 << 10
+
+sys.path.insert(0, str(ROOT))
+os.chdir(ROOT)
+import evaluate  # noqa: E402
+
+
+def within(seconds, run):
+    """Call run in a thread; return its result, or None if it is still going."""
+    result = []
+    thread = threading.Thread(target=lambda: result.append(run()), daemon=True)
+    thread.start()
+    thread.join(seconds)
+    return result[0] if result else None
+
+
+def main():
+    ballast = bytearray(b"\1" * (BALLAST_MB << 20))
+    solver = ["./coil_check/solve", "-m", "0"]
+    level = LEVEL.read_text()
+
+    # Started straight from the harness, the solver reports the harness.
+    plain = subprocess.Popen(solver, stdin=subprocess.PIPE, stdout=subprocess.DEVNULL)
+    plain.stdin.write(level.encode("utf-8"))
+    plain.stdin.close()
+    inherited = os.wait4(plain.pid, 0)[2].ru_maxrss
+    plain.returncode = 0
+    run = evaluate.run_measured(solver, level, 60)
+    piped = evaluate.run_solver_pipelined(solver, level, LEVEL, 60, False)
+    slow = within(10, lambda: evaluate.run_measured(["sleep", "30"], "", 0.5))
+
+    cases = [
+        ("harness is large", inherited >= BALLAST_MB << 10, f"{inherited} kB"),
+        ("solver run", run.returncode == 0 and 0 < run.usage.max_rss_kb < SMALL_KB, run.usage),
+        ("pipelined solver", piped.valid and 0 < piped.solver_usage.max_rss_kb < SMALL_KB, piped.solver_usage),
+        ("pipelined checker", piped.valid and 0 < piped.checker_usage.max_rss_kb < SMALL_KB, piped.checker_usage),
+        ("timeout", slow is not None and slow.timed_out, slow),
+    ]
+    del ballast
+
+    failed = 0
+    for name, ok, detail in cases:
+        print(f"{'ok' if ok else 'FAIL'}: {name}")
+        if not ok:
+            print(f"    {detail}")
+            failed += 1
+    return 1 if failed else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,42 @@
+#ifndef COIL_PARSE_H
+#define COIL_PARSE_H
+
+#include <stdbool.h>
+
+#include "grid.h"
+
+// Match a literal prefix.
+static inline bool parse_lit(char const** const p, char const* const end, char const* lit)
+{
+	char const* i = *p;
+	for (; *lit; ++i, ++lit)
+	{
+		if (i == end || *i != *lit) return false;
+	}
+	*p = i;
+	return true;
+}
+
+// Parse an unsigned decimal number, skipping leading white space like %u.
+static inline bool parse_u4(char const** const p, char const* const end, u4* const v)
+{
+	char const* i = *p;
+	while (i != end && (*i == ' ' || (*i >= '\t' && *i <= '\r'))) ++i;
+	if (i == end || *i < '0' || *i > '9') return false;
+
+	u4 n = 0;
+	do
+	{
+		u4 const digit = *i - '0';
+		if (n > (0xFFFFFFFFu - digit) / 10) return false;
+		n = n * 10 + digit;
+		++i;
+	}
+	while (i != end && *i >= '0' && *i <= '9');
+
+	*v = n;
+	*p = i;
+	return true;
+}
+
+#endif
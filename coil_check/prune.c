@@ -0,0 +1,445 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "prune.h"
+
+// Kernels are inlined into a copy for each stride.
+#define KERNEL static inline __attribute__((always_inline))
+
+// Adjust the counts for a free cell with e ways in.
+static inline void tally(pruner* const p, u4 const e, s4 const s)
+{
+	if (e == 0)      p->isolated  += s;
+	else if (e == 1) p->dead_ends += s;
+}
+
+static inline void retally(pruner* const p, u4 const from, u4 const to)
+{
+	tally(p, from, -1);
+	tally(p, to, 1);
+}
+
+// The head counts as a way into its free neighbours.  Add it, or with on
+// false, take it away again.
+KERNEL void head_bonus(pruner* const p, u4 const head, bool const on, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	for (u4 k = 0; k != 4; ++k)
+	{
+		u4 const u = head + delta[k];
+		if (!p->cells[u]) continue;
+		if (on) retally(p, p->degree[u], p->degree[u] + 1);
+		else    retally(p, p->degree[u] + 1, p->degree[u]);
+	}
+}
+
+// First stamp of n fresh ones.
+static u4 stamps(pruner* const p, u4 const n)
+{
+	if (p->epoch > ~0u - n - 1)
+	{
+		memset(p->mark, 0, (size_t)p->w * p->h * sizeof(*p->mark));
+		p->epoch = 0;
+	}
+	u4 const base = p->epoch + 1;
+	p->epoch += n;
+	return base;
+}
+
+bool pruner_init(pruner* const p, u1* const cells, u4 const w, u4 const h)
+{
+	size_t const n     = (size_t)w * h;
+	size_t const queue = n > PRUNE_SEEDS * PRUNE_BUDGET ? n : PRUNE_SEEDS * PRUNE_BUDGET;
+	memset(p, 0, sizeof(*p));
+	p->cells    = cells;
+	p->w        = w;
+	p->h        = h;
+	p->delta[0] = -1;
+	p->delta[1] = -(s4)w;
+	p->delta[2] = 1;
+	p->delta[3] = (s4)w;
+	p->degree   = malloc(n);
+	p->mark     = calloc(n, sizeof(*p->mark));
+	p->queue    = malloc(queue * sizeof(*p->queue));
+	p->low      = malloc(n * sizeof(*p->low));
+	p->step     = malloc(n);
+	if (!p->degree || !p->mark || !p->queue || !p->low || !p->step)
+	{
+		pruner_free(p);
+		return false;
+	}
+	return true;
+}
+
+void pruner_free(pruner* const p)
+{
+	free(p->degree);
+	free(p->mark);
+	free(p->queue);
+	free(p->low);
+	free(p->step);
+	p->degree = NULL;
+	p->mark   = NULL;
+	p->queue  = NULL;
+	p->low    = NULL;
+	p->step   = NULL;
+}
+
+bool pruner_reset(pruner* const p, u4 const head)
+{
+	u1* const cells = p->cells;
+	u4 const  w     = p->w;
+	u4        empty = 0;
+	u4        seed  = 0;
+	p->isolated  = 0;
+	p->dead_ends = 0;
+	for (u4 i = 0; i != w * p->h; ++i)
+	{
+		u4 const x = i % w;
+		u4 const y = i / w;
+		if (x == 0 || y == 0 || x == w - 1 || y == p->h - 1)
+		{
+			p->degree[i] = 4;
+			continue;
+		}
+		p->degree[i] = (cells[i - 1] != 0) + (cells[i + 1] != 0) + (cells[i - w] != 0) + (cells[i + w] != 0);
+	}
+	for (u4 i = w; i != w * (p->h - 1); ++i)
+	{
+		if (!cells[i]) continue;
+		tally(p, p->degree[i], 1);
+		++empty;
+		seed = i;
+	}
+	head_bonus(p, head, true, (s4)w);
+	p->left = empty;
+	if (p->isolated != 0 || p->dead_ends > 1) return false;
+	if (empty == 0) return true;
+
+	// The free cells have to be in one piece.
+	u4 const stamp = stamps(p, 1);
+	u4       top   = 0;
+	u4       seen  = 1;
+	p->mark[seed]    = stamp;
+	p->queue[top++] = seed;
+	while (top != 0)
+	{
+		u4 const i = p->queue[--top];
+		for (u4 k = 0; k != 4; ++k)
+		{
+			u4 const u = i + p->delta[k];
+			if (!cells[u] || p->mark[u] == stamp) continue;
+			p->mark[u]       = stamp;
+			p->queue[top++] = u;
+			++seen;
+		}
+	}
+	return seen == empty;
+}
+
+KERNEL u4 slide(pruner* const p, u4 const i, u1 const k, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	if (p->credit < PRUNE_SPLIT_SAVED) p->credit += PRUNE_SPLIT_SHARE;
+	u1* const cells = p->cells;
+	s4 const  d     = delta[k];
+	head_bonus(p, i, false, w);
+	u4 j = i;
+	do
+	{
+		j += d;
+		tally(p, p->degree[j], -1);
+		cells[j] = 0;
+		--p->left;
+		for (u4 e = 0; e != 4; ++e)
+		{
+			u4 const u = j + delta[e];
+			--p->degree[u];
+			if (cells[u]) retally(p, p->degree[u] + 1, p->degree[u]);
+		}
+	}
+	while (cells[j + d]);
+	head_bonus(p, j, true, w);
+	return j;
+}
+
+KERNEL void undo(pruner* const p, u4 const i, u4 j, u1 const k, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	u1* const cells = p->cells;
+	s4 const  d     = delta[k];
+	head_bonus(p, j, false, w);
+	for (; j != i; j -= d)
+	{
+		cells[j] = 1;
+		++p->left;
+		for (u4 e = 0; e != 4; ++e)
+		{
+			u4 const u = j + delta[e];
+			++p->degree[u];
+			if (cells[u]) retally(p, p->degree[u] - 1, p->degree[u]);
+		}
+		tally(p, p->degree[j], 1);
+	}
+	head_bonus(p, i, true, w);
+}
+
+// Whether the free cells next to the slide are still in one piece.  A search
+// runs from the first cell of each stretch of free cells along either side,
+// all of them a step at a time.  Searches that meet are joined; once all are
+// joined the cells are connected, and if one group runs out of cells first it
+// has been cut off.  If the budget runs out first, the slide is given the
+// benefit of the doubt.
+KERNEL bool connected(pruner* const p, u4 const i, u4 const j, u1 const k, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	u1 const* const cells = p->cells;
+	s4 const        d     = delta[k];
+	s4 const        side  = delta[(k + 1) & 3];
+
+	u4 seeds[PRUNE_SEEDS];
+	u4 n = 0;
+	for (s4 s = -1; s <= 1 && n != PRUNE_SEEDS; s += 2)
+	{
+		bool run = false;
+		for (u4 v = i + d;; v += d)
+		{
+			bool const open = cells[v + s * side] != 0;
+			if (open && !run)
+			{
+				if (n == PRUNE_SEEDS) break;
+				seeds[n++] = v + s * side;
+			}
+			run = open;
+			if (v == j) break;
+		}
+	}
+	if (n < 2) return true;
+
+	u4 const base = stamps(p, n);
+	u4       group[PRUNE_SEEDS];
+	u4       head[PRUNE_SEEDS];
+	u4       tail[PRUNE_SEEDS];
+	u4       active[PRUNE_SEEDS];
+	u4       groups = 0;
+	for (u4 s = 0; s != n; ++s)
+	{
+		u4* const q = p->queue + s * PRUNE_BUDGET;
+		group[s]  = s;
+		head[s]   = 0;
+		tail[s]   = 0;
+		active[s] = 0;
+		if (p->mark[seeds[s]] >= base) continue; // Also a seed of an earlier search.
+		p->mark[seeds[s]] = base + s;
+		q[tail[s]++]      = seeds[s];
+		active[s]         = 1;
+		++groups;
+	}
+
+	for (u4 budget = PRUNE_BUDGET; budget != 0; --budget)
+	{
+		bool stepped = false;
+		for (u4 s = 0; s != n; ++s)
+		{
+			if (head[s] == tail[s]) continue;
+			stepped = true;
+
+			u4* const q = p->queue + s * PRUNE_BUDGET;
+			u4 const  c = q[head[s]++];
+			for (u4 e = 0; e != 4; ++e)
+			{
+				u4 const u = c + delta[e];
+				if (!cells[u]) continue;
+				u4 const m = p->mark[u];
+				if (m >= base)
+				{
+					// Met another search.
+					u4 a = s;
+					u4 b = m - base;
+					while (group[a] != a) a = group[a];
+					while (group[b] != b) b = group[b];
+					if (a == b) continue;
+					group[b]   = a;
+					active[a] += active[b];
+					if (--groups == 1) return true;
+					continue;
+				}
+				if (tail[s] == PRUNE_BUDGET) return true;
+				p->mark[u]   = base + s;
+				q[tail[s]++] = u;
+			}
+
+			if (head[s] == tail[s])
+			{
+				u4 a = s;
+				while (group[a] != a) a = group[a];
+				if (--active[a] == 0) return false;
+			}
+		}
+		if (!stepped) break;
+	}
+	return true;
+}
+
+// Whether some cell splits the free cells into more pieces than a walk from
+// head can cover.  The walk passes a cut cell once, so the cells left without
+// it have to fall in at most two pieces: one the walk comes from, and one it
+// goes on into and ends in.  All the pieces it has to end in must overlap, and
+// the head itself must not cut anything off.
+//
+// A depth-first search from the head finds the cut cells.  Each piece cut off
+// below one is a subtree of the search, and so a range of discovery times;
+// the ranges have to share a time.
+KERNEL bool split(pruner* const p, u4 const head, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	u1 const* const cells = p->cells;
+	u4* const       mark  = p->mark;
+	u4* const       low   = p->low;
+	u4* const       stack = p->queue;
+	u4 const        base  = stamps(p, p->left + 1);
+	u4              time  = base;
+	u4              sp    = 0;
+	u4              roots = 0;
+	u4              first = 0;
+	u4              last  = ~0u;
+
+	mark[head] = low[head] = time++;
+	p->step[head] = 0;
+	stack[sp++]   = head;
+	while (sp != 0)
+	{
+		u4 const v = stack[sp - 1];
+		if (p->step[v] != 4)
+		{
+			u4 const u = v + delta[p->step[v]++];
+			if (u != head && !cells[u]) continue;
+			if (mark[u] >= base)
+			{
+				if (mark[u] < low[v]) low[v] = mark[u];
+				continue;
+			}
+			mark[u] = low[u] = time++;
+			p->step[u]       = 0;
+			stack[sp++]      = u;
+			roots           += v == head;
+			continue;
+		}
+
+		if (--sp == 0) break;
+		u4 const a = stack[sp - 1];
+		if (low[v] < low[a]) low[a] = low[v];
+		if (a != head && low[v] >= mark[a])
+		{
+			// The subtree below v is cut off by a.
+			if (mark[v] > first) first = mark[v];
+			if (time - 1 < last) last = time - 1;
+			if (first > last) return true;
+		}
+	}
+	return roots > 1 || time - base - 1 != p->left;
+}
+
+// Whether free cell u could be a cut cell: its free neighbours are not joined
+// to each other through the cells around it.
+KERNEL bool pinched(pruner const* const p, u4 const u, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	u1 const* const cells = p->cells;
+	u4              free  = 0;
+	u4              joins = 0;
+	for (u4 e = 0; e != 4; ++e)
+	{
+		u4 const a = u + delta[e];
+		u4 const b = u + delta[(e + 1) & 3];
+		if (!cells[a]) continue;
+		++free;
+		joins += cells[b] && cells[a + delta[(e + 1) & 3]];
+	}
+	return free - (joins == 4 ? 3 : joins) > 1;
+}
+
+// Whether the slide from i in direction k that stopped on j can have made a
+// new cut cell, because one of the cells around it has been pinched.
+KERNEL bool cut_near(pruner const* const p, u4 const i, u4 const j, u1 const k, s4 const w)
+{
+	s4 const delta[4] = { -1, -w, 1, w };
+	s4 const d    = delta[k];
+	s4 const side = delta[(k + 1) & 3];
+	for (u4 v = i;; v += d)
+	{
+		if (p->cells[v + side] && pinched(p, v + side, w)) return true;
+		if (p->cells[v - side] && pinched(p, v - side, w)) return true;
+		if (v == j) break;
+	}
+	return (p->cells[i - d] && pinched(p, i - d, w)) || (p->cells[j + d] && pinched(p, j + d, w));
+}
+
+// Whether a search for cut cells, which looks at every free cell, fits in the
+// time saved up for it.  Each slide adds a little, so it runs after every
+// slide on small boards and after every so many on large ones.
+static bool afford(pruner* const p)
+{
+	if (p->credit < p->left) return false;
+	p->credit -= p->left;
+	return true;
+}
+
+// The counts are read while the search runs, so they are stored atomically;
+// only this worker writes them.
+KERNEL bool hopeless(pruner* const p, u4 const i, u4 const j, u1 const k, s4 const w)
+{
+	prune_rule rule;
+	if (p->isolated != 0) rule = PRUNE_ISOLATED;
+	else if (p->dead_ends > 1) rule = PRUNE_DEAD_ENDS;
+	else if (!connected(p, i, j, k, w)) rule = PRUNE_DISCONNECTED;
+	else if (cut_near(p, i, j, k, w) && afford(p) && split(p, j, w)) rule = PRUNE_SPLIT;
+	else return false;
+	__atomic_store_n(&p->pruned[rule], p->pruned[rule] + 1, __ATOMIC_RELAXED);
+	return true;
+}
+
+// The exported calls pass the stride as a constant for the strides the grid
+// is padded to, so that every neighbour is at an immediate offset.
+#define STRIDES(X) X(16) X(32) X(64) X(128) X(256) X(512) X(1024) X(2048) X(PRUNE_MAX_STRIDE)
+
+u4 pruner_stride(u4 const w)
+{
+	if (w > PRUNE_MAX_STRIDE) return w;
+	u4 stride = 16;
+	while (stride < w) stride *= 2;
+	return stride;
+}
+
+u4 pruner_slide(pruner* const p, u4 const i, u1 const k)
+{
+	switch (p->w)
+	{
+#define CASE(w) case w: return slide(p, i, k, w);
+		STRIDES(CASE)
+#undef CASE
+		default: return slide(p, i, k, (s4)p->w);
+	}
+}
+
+void pruner_undo(pruner* const p, u4 const i, u4 const j, u1 const k)
+{
+	switch (p->w)
+	{
+#define CASE(w) case w: undo(p, i, j, k, w); return;
+		STRIDES(CASE)
+#undef CASE
+		default: undo(p, i, j, k, (s4)p->w);
+	}
+}
+
+bool pruner_hopeless(pruner* const p, u4 const i, u4 const j, u1 const k)
+{
+	switch (p->w)
+	{
+#define CASE(w) case w: return hopeless(p, i, j, k, w);
+		STRIDES(CASE)
+#undef CASE
+		default: return hopeless(p, i, j, k, (s4)p->w);
+	}
+}
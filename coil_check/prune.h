@@ -0,0 +1,79 @@
+#ifndef COIL_PRUNE_H
+#define COIL_PRUNE_H
+
+#include "grid.h"
+
+// Widest row stride with kernels of its own.
+#define PRUNE_MAX_STRIDE 4096
+
+// Most connectivity searches seeded per slide.
+#define PRUNE_SEEDS 16
+
+// Cells a connectivity search may visit before it gives up.
+#define PRUNE_BUDGET 4096
+
+// Cells the search for cut cells may look at per slide, on average, and at
+// most in one go.
+#define PRUNE_SPLIT_SHARE 16
+#define PRUNE_SPLIT_SAVED (1u << 24)
+
+// Rules a slide can be found hopeless by, in the order they are tried.
+typedef enum prune_rule
+{
+	PRUNE_ISOLATED,     // A free cell is left with no way in.
+	PRUNE_DEAD_ENDS,    // More than one free cell could only end the path.
+	PRUNE_DISCONNECTED, // The cells along the slide are no longer joined.
+	PRUNE_SPLIT,        // A cut cell leaves more pieces than the walk can cover.
+	PRUNE_RULES,
+} prune_rule;
+
+// Pruning for the solver.  It makes and undoes the slides itself, so that it
+// can keep the number of free neighbours of every cell up to date, and from
+// those the number of free cells that no move can reach and that the path
+// could only end on.  After a slide it also checks that the cells along it
+// are still connected to each other, and now and then that no cell cuts them
+// into pieces the walk cannot all cover.
+typedef struct pruner
+{
+	u1* cells;     // The solver's grid; non-zero is free.
+	u4  w;
+	u4  h;
+	s4  delta[4];
+	u1* degree;    // Free neighbours of each cell.
+	u4  isolated;  // Free cells with no way in.
+	u4  dead_ends; // Free cells with a single way in, which must end the path.
+	u4* mark;      // Stamps of the connectivity searches.
+	u4  epoch;
+	u4* queue;
+	u4* low;       // Lowest stamp each cell reaches, when looking for cut cells.
+	u1* step;      // Next direction to look in from each cell.
+	u4  left;      // Free cells.
+	u4  credit;    // Cells the search for cut cells may look at.
+	u8  pruned[PRUNE_RULES]; // Slides found hopeless, by rule.
+} pruner;
+
+// Row stride to lay out a grid of width w in: the next power of two, which
+// the kernels are specialized for, up to PRUNE_MAX_STRIDE.
+u4 pruner_stride(u4 w);
+
+// Set up for the grid cells of h rows, w cells apart.  Cells past the end of
+// each row have to be blocked.
+bool pruner_init(pruner* p, u1* cells, u4 w, u4 h);
+
+void pruner_free(pruner* p);
+
+// Count everything afresh for a walk that has just started on cell head.
+// Returns false if the board cannot be solved from there.
+bool pruner_reset(pruner* p, u4 head);
+
+// Slide from cell i in direction k and return the cell it stops on.
+u4 pruner_slide(pruner* p, u4 i, u1 k);
+
+// Undo the slide from i in direction k that stopped on j.
+void pruner_undo(pruner* p, u4 i, u4 j, u1 k);
+
+// Whether the walk can no longer be completed after the slide from i in
+// direction k that stopped on j.
+bool pruner_hopeless(pruner* p, u4 i, u4 j, u1 k);
+
+#endif
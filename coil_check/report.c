@@ -0,0 +1,153 @@
+#include <stdlib.h>
+#include <string.h>
+
+#include "report.h"
+
+// Marks a labelled cell in the union-find array; the rest is its region.
+#define LABEL (1u << 31)
+
+static u4 find(u4* const parent, u4 i)
+{
+	while (parent[i] != i)
+	{
+		parent[i] = parent[parent[i]];
+		i         = parent[i];
+	}
+	return i;
+}
+
+bool report_build(report* const r, decoder const* const d)
+{
+	grid const* const g = d->g;
+	u4 const          w = g->w;
+	u4 const          h = g->h;
+
+	memset(r, 0, sizeof(*r));
+	r->move      = d->moves;
+	r->remaining = d->remaining;
+	r->placed    = d->pos != 0;
+	r->x         = d->pos % w - 1;
+	r->y         = d->pos / w - 1;
+
+	if ((u8)w * h >= LABEL) return false;
+	u4* const parent = malloc((size_t)w * h * sizeof(*parent));
+	if (!parent) return false;
+
+	// Union free cells with their free left and upper neighbours.  The root of
+	// a region is always its first cell in row order.
+	u4 components = 0;
+	for (u4 y = 1; y != h - 1; ++y)
+	{
+		for (u4 i = y * w + 1, e = i + w - 2; i != e; ++i)
+		{
+			if (!grid_free(g, i)) continue;
+			parent[i] = i;
+			++components;
+			if (grid_free(g, i - 1))
+			{
+				parent[i] = find(parent, i - 1);
+				--components;
+			}
+			if (grid_free(g, i - w))
+			{
+				u4 const a = find(parent, i - w);
+				u4 const b = parent[i];
+				if (a != b)
+				{
+					if (a < b) parent[b] = a;
+					else       parent[a] = b;
+					parent[i] = a < b ? a : b;
+					--components;
+				}
+			}
+		}
+	}
+
+	region* const regions = malloc((components + 1) * sizeof(*regions));
+	if (!regions)
+	{
+		free(parent);
+		return false;
+	}
+
+	// Number the regions in row order and gather their sizes and bounds.  A
+	// cell's parent comes before it, so it has been labelled already.
+	u4 next = 0;
+	for (u4 y = 1; y != h - 1; ++y)
+	{
+		for (u4 x = 1; x != w - 1; ++x)
+		{
+			u4 const i = y * w + x;
+			if (!grid_free(g, i)) continue;
+
+			u4 id;
+			if (parent[i] == i)
+			{
+				id = next++;
+				region* const n = &regions[id];
+				n->cells   = 0;
+				n->x0      = x - 1;
+				n->x1      = x - 1;
+				n->y0      = y - 1;
+				n->y1      = y - 1;
+				n->at_head = false;
+			}
+			else
+			{
+				id = parent[parent[i]] & ~LABEL;
+			}
+			parent[i] = LABEL | id;
+
+			region* const n = &regions[id];
+			++n->cells;
+			if (x - 1 < n->x0) n->x0 = x - 1;
+			if (x - 1 > n->x1) n->x1 = x - 1;
+			n->y1 = y - 1;
+
+			u4 const degree = grid_free(g, i - 1) + grid_free(g, i + 1) +
+				grid_free(g, i - w) + grid_free(g, i + w);
+			if (degree == 1) ++r->dead_ends;
+			if (degree == 0) ++r->isolated;
+		}
+	}
+	r->components = components;
+
+	if (r->placed)
+	{
+		for (u4 k = 0; k != 4; ++k)
+		{
+			u4 const n = d->pos + d->delta[k];
+			if (grid_free(g, n)) regions[parent[n] & ~LABEL].at_head = true;
+		}
+	}
+
+	// Keep the largest regions, the earlier one first on a tie.
+	for (u4 id = 0; id != components; ++id)
+	{
+		u4 k = r->listed;
+		while (k != 0 && regions[id].cells > r->regions[k - 1].cells) --k;
+		if (k == REPORT_REGIONS) continue;
+		u4 const last = r->listed == REPORT_REGIONS ? REPORT_REGIONS - 1 : r->listed++;
+		memmove(&r->regions[k + 1], &r->regions[k], (last - k) * sizeof(*r->regions));
+		r->regions[k] = regions[id];
+	}
+
+	free(regions);
+	free(parent);
+	return true;
+}
+
+void report_print(FILE* const out, report const* const r)
+{
+	fprintf(out, "{\"move\":%llu", r->move);
+	if (r->placed) fprintf(out, ",\"x\":%u,\"y\":%u", r->x, r->y);
+	fprintf(out, ",\"remaining\":%u,\"components\":%u,\"dead_ends\":%u,\"isolated\":%u,\"regions\":[",
+		r->remaining, r->components, r->dead_ends, r->isolated);
+	for (u4 k = 0; k != r->listed; ++k)
+	{
+		region const* const n = &r->regions[k];
+		fprintf(out, "%s{\"cells\":%u,\"x0\":%u,\"y0\":%u,\"x1\":%u,\"y1\":%u,\"at_head\":%s}",
+			k ? "," : "", n->cells, n->x0, n->y0, n->x1, n->y1, n->at_head ? "true" : "false");
+	}
+	fprintf(out, "]}");
+}
@@ -0,0 +1,46 @@
+#ifndef COIL_REPORT_H
+#define COIL_REPORT_H
+
+#include <stdio.h>
+
+#include "decode.h"
+
+// Regions listed in a report, largest first.
+#define REPORT_REGIONS 16
+
+// A connected region of unvisited cells, with its bounding box in board
+// coordinates.
+typedef struct region
+{
+	u4   cells;
+	u4   x0;
+	u4   y0;
+	u4   x1;
+	u4   y1;
+	bool at_head; // Next to the cell the walk stopped on.
+} region;
+
+// Summary of what a failed solution left unvisited, small enough to print for
+// any board size.
+typedef struct report
+{
+	u8     move;       // Index of the failing move, or the move count.
+	bool   placed;     // Whether the walk got as far as its start cell.
+	u4     x;          // Cell the walk stopped on, if placed.
+	u4     y;
+	u4     remaining;  // Free cells not visited.
+	u4     components; // Connected regions among them.
+	u4     dead_ends;  // Free cells with one free neighbour.
+	u4     isolated;   // Free cells with no free neighbour.
+	u4     listed;
+	region regions[REPORT_REGIONS];
+} report;
+
+// Summarize the grid a failed decoder has left behind, in one labelling pass
+// over the board.  Returns false if out of memory.
+bool report_build(report* r, decoder const* d);
+
+// Print the report as a JSON object.
+void report_print(FILE* out, report const* r);
+
+#endif
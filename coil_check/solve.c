@@ -0,0 +1,1068 @@
+#define _DEFAULT_SOURCE
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <getopt.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "checkpoint.h"
+#include "decode.h"
+#include "encode.h"
+#include "level.h"
+#include "parse.h"
+#include "prune.h"
+#include "table.h"
+
+// Reference solver.  A depth-first search over slides from every start cell in
+// turn, on the checker's bordered byte grid: a slide clears its cells in place
+// and putting them back undoes it, so nothing is ever copied.  Branches that
+// leave cells behind that can no longer all be visited are cut off right after
+// the slide.
+//
+// With several jobs every worker searches its own copy of the grid.  The start
+// cells are handed out one at a time, and once they have all gone a worker
+// with nothing to do gets the subtrees below the first few moves of a busy
+// worker's search.  States found dead are shared between the workers through
+// a transposition table.
+//
+// With a checkpoint file, the workers are stopped every so often at their
+// next node, long enough to copy where each of them has got to, and what is
+// left is written out while they carry on.  A later run on the same board
+// picks the search up from there.
+//
+// Each worker keeps its own counters, and only it writes them.  A progress
+// report reads them all as they stand, without stopping anyone.
+
+// Deepest move a subtree can be handed over below.
+#define SPLIT_DEPTH 16
+
+// Default size of the table of dead states.
+#define TABLE_MEGABYTES 16
+
+// Default seconds between checkpoints.
+#define CHECKPOINT_SECONDS 300
+
+// Smallest subtree worth keeping in the table.  Most dead states are found so
+// by the pruning right away, and would just push the others out.
+#define TABLE_MIN_NODES 8
+
+// Names of the pruning rules in the statistics, in prune_rule order.
+static char const* const rule_names[PRUNE_RULES] = { "isolated", "dead_ends", "disconnected", "split" };
+
+// A subtree of the search: the walk from start after the given moves.
+typedef struct task
+{
+	u4 start;
+	u1 depth;
+	u1 moves[SPLIT_DEPTH];
+} task;
+
+// Subtrees handed over by a worker.  It takes them back from the tail and
+// the others steal from the head, which are the larger ones.
+typedef struct deque
+{
+	task* items;
+	u4    head;
+	u4    tail;
+	u4    size;
+} deque;
+
+struct solver;
+
+// A node of the search where the walk had a choice.
+typedef struct frame
+{
+	u8   nodes;   // Nodes searched before this one.
+	u4   cell;
+	u4   depth;   // Moves on the journal when the walk got here.
+	u4   given;   // Subtrees handed over by then.
+	u1   next;    // Direction to try next.
+	bool on_path; // On a walk being picked up again.
+} frame;
+
+typedef struct pool
+{
+	pthread_mutex_t  lock;
+	pthread_cond_t   wake;
+	pthread_cond_t   settled;     // A worker stopped or finished.
+	pthread_cond_t   resume;      // The checkpoint has been taken.
+	deque*           deques;
+	u4               workers;
+	u4 const*        starts;      // Start cells, handed out in order.
+	u4               start_count;
+	u4               next_start;
+	checkpoint_walk* resumes;     // Walks to pick up again, handed out first.
+	u4               resume_count;
+	u4               next_resume;
+	u4               free_cells;
+	u4               queued;      // Subtrees in the deques.
+	u4               busy;        // Workers on a task.
+	u4               hungry;      // Workers waiting for a task.
+	u4               running;     // Workers not finished yet.
+	u4               parked;      // Workers stopped for a checkpoint.
+	bool             pause;
+	bool             found;
+	struct solver*   winner;
+	table            dead;
+	u8               restored;    // Nodes searched before the checkpoint resumed from.
+	double           reported;    // Seconds into the search of the last report.
+} pool;
+
+typedef struct solver
+{
+	u1*    cells;     // This worker's copy of the grid; non-zero is free.
+	s4     delta[4];
+	u4     start;
+	u4     remaining; // Free cells not visited yet.
+	u1*    moves;     // Directions taken so far, in delta order.
+	u4*    from;      // Cell each of those moves started from.
+	u4     depth;
+	u4     fixed;     // Moves the task started with.
+	u1*    path;      // Moves of a walk being picked up again,
+	u4     path_depth; // until the search first turns back from it.
+	task   held;      // The subtree taken, when it is one.
+	frame* frames;    // Stack of the search.
+	bool   parked;    // Stopped in the middle of a task.
+	u8     hash;      // Zobrist hash of the visited cells.
+	pruner prune;
+	pool*  pool;
+	u4     id;
+	u4     given;     // Subtrees handed over.
+	u4     steals;    // Subtrees taken from other workers.
+	u4     deepest;   // Most moves on the journal at a node.
+	u4     least;     // Fewest free cells left at a node.
+	u8     nodes;
+	u8     hits;      // Nodes found dead in the table.
+	u8     stores;
+	u8     reported;  // Nodes at the last progress report.
+} solver;
+
+// Add to a counter of this worker's, which a progress report may be reading.
+static inline void add_count(u8* const counter, u8 const n)
+{
+	__atomic_store_n(counter, *counter + n, __ATOMIC_RELAXED);
+}
+
+static bool deque_push(deque* const q, task const* const t)
+{
+	if (q->head == q->tail) q->head = q->tail = 0;
+	if (q->tail == q->size)
+	{
+		u4 const    size  = q->size ? 2 * q->size : 16;
+		task* const items = realloc(q->items, size * sizeof(*items));
+		if (!items) return false;
+		q->items = items;
+		q->size  = size;
+	}
+	q->items[q->tail++] = *t;
+	return true;
+}
+
+// Hand the subtree below move k from cell i over to a worker that is waiting
+// for one, as long as this worker still has a later move to try itself.
+static bool donate(solver* const s, u4 const i, u1 const k)
+{
+	pool* const p = s->pool;
+	if (s->depth >= SPLIT_DEPTH || !__atomic_load_n(&p->hungry, __ATOMIC_RELAXED)) return false;
+	u1 later = k + 1;
+	while (later != 4 && !s->cells[i + s->delta[later]]) ++later;
+	if (later == 4) return false;
+
+	pthread_mutex_lock(&p->lock);
+	bool given = !p->found && p->queued < p->hungry;
+	if (given)
+	{
+		task t = { s->start, s->depth + 1, { 0 } };
+		memcpy(t.moves, s->moves, s->depth);
+		t.moves[s->depth] = k;
+		given = deque_push(&p->deques[s->id], &t);
+	}
+	if (given)
+	{
+		__atomic_store_n(&s->given, s->given + 1, __ATOMIC_RELAXED);
+		++p->queued;
+		pthread_cond_signal(&p->wake);
+	}
+	pthread_mutex_unlock(&p->lock);
+	return given;
+}
+
+// The only direction out of cell i, or 4 if there is none or more than one.
+static u1 forced_move(solver const* const s, u4 const i)
+{
+	u1 dir = 4;
+	for (u1 k = 0; k != 4; ++k)
+	{
+		if (!s->cells[i + s->delta[k]]) continue;
+		if (dir != 4) return 4;
+		dir = k;
+	}
+	return dir;
+}
+
+// Slide from cell i in direction k, stopping on j, and account for it.  The
+// start cell and direction of every slide go on the journal, s->from and
+// s->moves; where it stopped is where the next one starts.
+static void take(solver* const s, u4 const i, u4 const j, u1 const k)
+{
+	s4 const        d    = s->delta[k];
+	u8 const* const keys = s->pool->dead.keys;
+	for (u4 c = i; c != j;) s->hash ^= keys[c += d];
+	s->remaining        -= (s4)(j - i) / d;
+	s->from[s->depth]    = i;
+	s->moves[s->depth++] = k;
+}
+
+// Undo the slides on the journal down to the given depth, the last of which
+// stopped on j, and return the cell the walk is back on.
+static u4 unwind(solver* const s, u4 const depth, u4 j)
+{
+	u8 const* const keys = s->pool->dead.keys;
+	while (s->depth != depth)
+	{
+		u4 const i = s->from[--s->depth];
+		u1 const k = s->moves[s->depth];
+		s4 const d = s->delta[k];
+		pruner_undo(&s->prune, i, j, k);
+		s->remaining += (s4)(j - i) / d;
+		for (u4 c = i; c != j;) s->hash ^= keys[c += d];
+		j = i;
+	}
+	return j;
+}
+
+// Wait while a checkpoint is taken.  Called with the pool locked.
+static void park(pool* const p)
+{
+	++p->parked;
+	pthread_cond_signal(&p->settled);
+	while (__atomic_load_n(&p->pause, __ATOMIC_RELAXED)) pthread_cond_wait(&p->resume, &p->lock);
+	--p->parked;
+}
+
+// Set up the node on cell i in frame f.  Returns false if there is nothing to
+// search below it.
+static bool enter(solver* const s, frame* const f, u4 const i)
+{
+	pool* const p = s->pool;
+	if (__atomic_load_n(&p->found, __ATOMIC_RELAXED)) return false;
+	if (__atomic_load_n(&p->pause, __ATOMIC_RELAXED))
+	{
+		pthread_mutex_lock(&p->lock);
+		s->parked = true;
+		park(p);
+		s->parked = false;
+		pthread_mutex_unlock(&p->lock);
+	}
+	if (table_dead(&p->dead, s->hash ^ table_head(&p->dead, i)))
+	{
+		add_count(&s->nodes, 1);
+		add_count(&s->hits, 1);
+		return false;
+	}
+	if (s->depth > s->deepest) __atomic_store_n(&s->deepest, s->depth, __ATOMIC_RELAXED);
+	if (s->remaining < s->least) __atomic_store_n(&s->least, s->remaining, __ATOMIC_RELAXED);
+
+	// On a walk being picked up again, the moves before the one it was on
+	// have been tried already.
+	f->nodes   = s->nodes;
+	add_count(&s->nodes, 1);
+	f->cell    = i;
+	f->depth   = s->depth;
+	f->given   = s->given;
+	f->on_path = s->depth < s->path_depth;
+	f->next    = f->on_path ? s->path[s->depth] : 0;
+	return true;
+}
+
+// Done with the node in frame f, with the walk back on its cell.
+static void leave(solver* const s, frame const* const f)
+{
+	// A subtree cut short, partly searched by another worker, or partly
+	// before a checkpoint, proves nothing.
+	pool* const p = s->pool;
+	u8 const    n = s->nodes - f->nodes;
+	if (n >= TABLE_MIN_NODES && s->given == f->given && !f->on_path && !__atomic_load_n(&p->found, __ATOMIC_RELAXED))
+	{
+		add_count(&s->stores, table_store(&p->dead, s->hash ^ table_head(&p->dead, f->cell), n));
+	}
+}
+
+// Depth-first search from cell i.  Each step takes a move and then every move
+// forced after it, so a corridor is walked in one go, however it bends, and
+// the search only branches where the walk has a choice.  Each branch point
+// has a frame on a stack allocated up front, rather than a call of its own.
+// Returns true with the solution on the journal, or false with the walk back
+// on cell i.
+static bool search(solver* const s, u4 const i)
+{
+	u1 const* const cells = s->cells;
+	frame* const    stack = s->frames;
+	u4              top   = 0;
+	if (!enter(s, &stack[top++], i)) return false;
+	for (;;)
+	{
+		frame* const f = &stack[top - 1];
+		if (f->next == 4)
+		{
+			leave(s, f);
+			if (--top == 0) return false;
+			frame* const parent = &stack[top - 1];
+			unwind(s, parent->depth, f->cell);
+			++parent->next;
+			s->path_depth = 0;
+			continue;
+		}
+
+		u1 dir = f->next;
+		if (!cells[f->cell + s->delta[dir]] || donate(s, f->cell, dir))
+		{
+			++f->next;
+			s->path_depth = 0;
+			continue;
+		}
+
+		u4   j = f->cell;
+		bool alive;
+		do
+		{
+			u4 const from = j;
+			j = pruner_slide(&s->prune, from, dir);
+			take(s, from, j, dir);
+			if (s->remaining == 0) return true;
+			alive = !pruner_hopeless(&s->prune, from, j, dir);
+		}
+		while (alive && (dir = forced_move(s, j)) != 4);
+
+		if (alive && enter(s, &stack[top], j))
+		{
+			++top;
+			continue;
+		}
+		unwind(s, f->depth, j);
+		++f->next;
+		s->path_depth = 0;
+	}
+}
+
+// Search a task on this worker's grid, and put the grid back as it was
+// unless the walk was completed.
+static bool run_task(solver* const s, checkpoint_walk const* const t)
+{
+	u1* const cells = s->cells;
+	u4        i     = t->start;
+	cells[i]      = 0;
+	s->start      = i;
+	s->remaining  = s->pool->free_cells - 1;
+	s->depth      = 0;
+	s->hash       = s->pool->dead.keys[i];
+	s->fixed      = t->fixed;
+	s->path       = t->moves;
+	s->path_depth = t->depth;
+	if (pruner_reset(&s->prune, i))
+	{
+		for (u4 m = 0; m != t->fixed; ++m)
+		{
+			u1 const k = t->moves[m];
+			u4 const j = pruner_slide(&s->prune, i, k);
+			take(s, i, j, k);
+			i = j;
+		}
+		if (s->remaining == 0) return true;
+		u4 const last = t->fixed - 1;
+		if ((t->fixed == 0 || !pruner_hopeless(&s->prune, s->from[last], i, t->moves[last])) && search(s, i)) return true;
+		unwind(s, 0, i);
+	}
+	cells[t->start] = 1;
+	return false;
+}
+
+// Take a task: a subtree from this worker's own deque, else one stolen from
+// another's, else a walk from a checkpoint, else the next start cell.  Called
+// with the pool locked.
+static bool pool_take(pool* const p, solver* const s, checkpoint_walk* const t)
+{
+	deque* q   = &p->deques[s->id];
+	bool   got = q->head != q->tail;
+	if (got) s->held = q->items[--q->tail];
+	for (u4 k = 1; !got && k != p->workers; ++k)
+	{
+		q   = &p->deques[(s->id + k) % p->workers];
+		got = q->head != q->tail;
+		if (got) s->held = q->items[q->head++];
+	}
+	if (got && q != &p->deques[s->id]) __atomic_store_n(&s->steals, s->steals + 1, __ATOMIC_RELAXED);
+	if (got)
+	{
+		--p->queued;
+		t->start = s->held.start;
+		t->fixed = t->depth = s->held.depth;
+		t->moves = s->held.moves;
+		return true;
+	}
+	if (p->next_resume != p->resume_count)
+	{
+		*t = p->resumes[p->next_resume++];
+		return true;
+	}
+	if (p->next_start == p->start_count) return false;
+	t->start = p->starts[p->next_start++];
+	t->fixed = t->depth = 0;
+	t->moves = NULL;
+	return true;
+}
+
+static void* worker_main(void* const arg)
+{
+	solver* const s = arg;
+	pool*   const p = s->pool;
+	pthread_mutex_lock(&p->lock);
+	while (!p->found)
+	{
+		if (__atomic_load_n(&p->pause, __ATOMIC_RELAXED))
+		{
+			park(p);
+			continue;
+		}
+		checkpoint_walk t;
+		if (pool_take(p, s, &t))
+		{
+			++p->busy;
+			pthread_mutex_unlock(&p->lock);
+			bool const found = run_task(s, &t);
+			pthread_mutex_lock(&p->lock);
+			--p->busy;
+			if (found && !p->found)
+			{
+				__atomic_store_n(&p->found, true, __ATOMIC_RELAXED);
+				__atomic_store_n(&s->least, 0, __ATOMIC_RELAXED);
+				p->winner = s;
+			}
+			continue;
+		}
+		// Nothing left, and nobody busy who could still hand work over.
+		if (p->busy == 0) break;
+		__atomic_add_fetch(&p->hungry, 1, __ATOMIC_RELAXED);
+		pthread_cond_wait(&p->wake, &p->lock);
+		__atomic_sub_fetch(&p->hungry, 1, __ATOMIC_RELAXED);
+	}
+	--p->running;
+	pthread_cond_signal(&p->settled);
+	pthread_cond_broadcast(&p->wake);
+	pthread_mutex_unlock(&p->lock);
+	return NULL;
+}
+
+static u1 free_neighbours(u1 const* const cells, s4 const* const delta, u4 const i)
+{
+	return !!cells[i + delta[0]] + !!cells[i + delta[1]] + !!cells[i + delta[2]] + !!cells[i + delta[3]];
+}
+
+// Rank of a start cell, higher first.  A dead end has to be one end of the
+// walk, and so most likely the start, then come the cells next to one, the
+// corners of the free space, and the ends of corridors, where the walk could
+// not easily have come from elsewhere.  Ties go to the cell nearer a corner
+// of the board, which is width cells wide with its border.
+static u8 start_key(grid const* const g, u4 const width, s4 const* const delta, u4 const i)
+{
+	u1 const* const cells  = g->cells;
+	u1 const        degree = free_neighbours(cells, delta, i);
+	u1              score  = 4 * (4 - degree);
+	bool            mouth  = false;
+	for (u1 k = 0; k != 4; ++k)
+	{
+		if (!cells[i + delta[k]]) continue;
+		u1 const next = free_neighbours(cells, delta, i + delta[k]);
+		if (next == 1) score += 3;
+		if (next != 2) mouth = true;
+	}
+	if (degree == 2)
+	{
+		bool const straight = (cells[i + delta[0]] && cells[i + delta[2]]) || (cells[i + delta[1]] && cells[i + delta[3]]);
+		if (!straight) score += 2;
+		if (mouth) score += 1;
+	}
+
+	u4 const x        = i % g->w - 1;
+	u4 const y        = i / g->w - 1;
+	u4 const dx       = x < width - 3 - x ? x : width - 3 - x;
+	u4 const dy       = y < g->h - 3 - y ? y : g->h - 3 - y;
+	u4 const distance = dx + dy < 0xFFFFFF ? dx + dy : 0xFFFFFF;
+	return (u8)(0xFF - score) << 56 | (u8)distance << 32 | i;
+}
+
+static int by_key(void const* const a, void const* const b)
+{
+	u8 const x = *(u8 const*)a;
+	u8 const y = *(u8 const*)b;
+	return x < y ? -1 : x > y;
+}
+
+// Put the start cells in the order to try them.
+static bool rank_starts(grid const* const g, u4 const width, s4 const* const delta, u4* const starts, u4 const count)
+{
+	u8* const keys = malloc(count * sizeof(*keys) + 1);
+	if (!keys) return false;
+	for (u4 k = 0; k != count; ++k) keys[k] = start_key(g, width, delta, starts[k]);
+	qsort(keys, count, sizeof(*keys), by_key);
+	for (u4 k = 0; k != count; ++k) starts[k] = (u4)keys[k];
+	free(keys);
+	return true;
+}
+
+// Whether a walk read from a checkpoint can be replayed on the board: it starts
+// on a free cell and every move leads into a free one.  The solver's slides do
+// not look before they step, so a stale or damaged checkpoint would otherwise
+// send them off the grid.  ends has room for a cell per move; cells is left as
+// it was.
+static bool walk_valid(u1* const cells, s4 const delta[4], u4 const area, u4 const free_cells, u4* const ends, checkpoint_walk const* const t)
+{
+	if (t->start >= area || !cells[t->start] || t->depth >= free_cells) return false;
+	u4   i  = t->start;
+	u4   m  = 0;
+	bool ok = true;
+	cells[i] = 0;
+	for (; ok && m != t->depth; ++m)
+	{
+		s4 const d = delta[t->moves[m]];
+		ends[m] = i;
+		ok      = cells[i + d] != 0;
+		while (cells[i + d]) cells[i += d] = 0;
+	}
+
+	// Put the board back.
+	for (u4 k = m; k-- != 0;)
+	{
+		s4 const d  = delta[t->moves[k]];
+		u4 const to = k + 1 != m ? ends[k + 1] : i;
+		for (u4 j = ends[k]; j != to;) cells[j += d] = 1;
+	}
+	cells[t->start] = 1;
+	return ok;
+}
+
+static bool add_walk(checkpoint* const c, u4 const start, u4 const fixed, u4 const depth, u1 const* const moves)
+{
+	checkpoint_walk* const t = &c->walks[c->count];
+	t->start = start;
+	t->fixed = fixed;
+	t->depth = depth;
+	t->moves = malloc(depth + 1);
+	if (!t->moves) return false;
+	memcpy(t->moves, moves, depth);
+	++c->count;
+	return true;
+}
+
+// Copy down what is left of the search, with every worker stopped.
+static bool capture(pool const* const p, solver const* const selves, checkpoint* const c)
+{
+	u4 count = p->workers + p->resume_count - p->next_resume;
+	for (u4 k = 0; k != p->workers; ++k) count += p->deques[k].tail - p->deques[k].head;
+	c->next_start = p->next_start;
+	c->nodes      = 0;
+	c->hits       = 0;
+	c->stores     = 0;
+	c->count      = 0;
+	c->walks      = malloc(count * sizeof(*c->walks) + 1);
+	if (!c->walks) return false;
+
+	bool ok = true;
+	for (u4 k = 0; k != p->workers; ++k)
+	{
+		solver const* const s = &selves[k];
+		c->nodes  += s->nodes;
+		c->hits   += s->hits;
+		c->stores += s->stores;
+		if (ok && s->parked) ok = add_walk(c, s->start, s->fixed, s->depth, s->moves);
+		deque const* const q = &p->deques[k];
+		for (u4 n = q->head; ok && n != q->tail; ++n)
+		{
+			ok = add_walk(c, q->items[n].start, q->items[n].depth, q->items[n].depth, q->items[n].moves);
+		}
+	}
+	for (u4 n = p->next_resume; ok && n != p->resume_count; ++n)
+	{
+		checkpoint_walk const* const t = &p->resumes[n];
+		ok = add_walk(c, t->start, t->fixed, t->depth, t->moves);
+	}
+	return ok;
+}
+
+// How to search, from the command line.
+typedef struct options
+{
+	bool        plain;
+	bool        verbose;
+	u4          workers;
+	long        megabytes;
+	char const* save;
+	long        seconds;
+	bool        with_table;
+	long        report;     // Seconds between progress reports; 0 for none.
+} options;
+
+// Seconds since the search began.
+static double since(struct timespec const* const began)
+{
+	struct timespec now;
+	clock_gettime(CLOCK_MONOTONIC, &now);
+	return (double)(now.tv_sec - began->tv_sec) + (now.tv_nsec - began->tv_nsec) / 1e9;
+}
+
+static bool earlier(struct timespec const* const a, struct timespec const* const b)
+{
+	return a->tv_sec != b->tv_sec ? a->tv_sec < b->tv_sec : a->tv_nsec < b->tv_nsec;
+}
+
+// Print the search statistics as a line of JSON on standard error: the totals,
+// then each worker's, with its nodes per second since the last report.  The
+// counters are read as they stand, so the workers can carry on meanwhile.
+static void report(pool* const p, solver* const selves, double const elapsed)
+{
+	u4 const     workers = p->workers;
+	double const span    = elapsed > p->reported ? elapsed - p->reported : 0.0;
+	u8           nodes   = 0;
+	u8           fresh   = 0; // Since the last report.
+	u8           hits    = 0;
+	u8           stores  = 0;
+	u4           steals  = 0;
+	u4           deepest = 0;
+	u4           least   = p->free_cells;
+	u8           pruned[PRUNE_RULES] = { 0 };
+	for (u4 k = 0; k != workers; ++k)
+	{
+		solver const* const s = &selves[k];
+		u8 const n = __atomic_load_n(&s->nodes, __ATOMIC_RELAXED);
+		u4 const d = __atomic_load_n(&s->deepest, __ATOMIC_RELAXED);
+		u4 const l = __atomic_load_n(&s->least, __ATOMIC_RELAXED);
+		nodes  += n;
+		fresh  += n - s->reported;
+		hits   += __atomic_load_n(&s->hits, __ATOMIC_RELAXED);
+		stores += __atomic_load_n(&s->stores, __ATOMIC_RELAXED);
+		steals += __atomic_load_n(&s->steals, __ATOMIC_RELAXED);
+		for (u4 r = 0; r != PRUNE_RULES; ++r) pruned[r] += __atomic_load_n(&s->prune.pruned[r], __ATOMIC_RELAXED);
+		if (d > deepest) deepest = d;
+		if (l < least) least = l;
+	}
+	u8 pruned_all = 0;
+	for (u4 r = 0; r != PRUNE_RULES; ++r) pruned_all += pruned[r];
+	u8 const slots = table_slots(&p->dead);
+	u8 const used  = table_occupied(&p->dead);
+
+	flockfile(stderr);
+	fprintf(stderr,
+		"{\"elapsed\":%.1f,\"nodes\":%llu,\"nodes_per_second\":%.0f,\"pruned\":%llu,\"prune_rate\":%.4f,\"pruned_by\":{",
+		elapsed, nodes, span > 0 ? fresh / span : 0.0, pruned_all, nodes > p->restored ? (double)pruned_all / (nodes - p->restored) : 0.0);
+	for (u4 r = 0; r != PRUNE_RULES; ++r) fprintf(stderr, "%s\"%s\":%llu", r ? "," : "", rule_names[r], pruned[r]);
+	fprintf(stderr,
+		"},\"table_hits\":%llu,\"table_hit_rate\":%.4f,\"table_stores\":%llu,\"table_slots\":%llu,"
+		"\"table_occupancy\":%.4f,\"max_depth\":%u,\"covered\":%.4f,\"steals\":%u,\"threads\":[",
+		hits, nodes ? (double)hits / nodes : 0.0, stores, slots, slots ? (double)used / slots : 0.0, deepest,
+		p->free_cells ? (double)(p->free_cells - least) / p->free_cells : 1.0, steals);
+	for (u4 k = 0; k != workers; ++k)
+	{
+		solver* const s = &selves[k];
+		u8 const      n = __atomic_load_n(&s->nodes, __ATOMIC_RELAXED);
+		u8            t = 0;
+		for (u4 r = 0; r != PRUNE_RULES; ++r) t += __atomic_load_n(&s->prune.pruned[r], __ATOMIC_RELAXED);
+		fprintf(stderr,
+			"%s{\"nodes\":%llu,\"nodes_per_second\":%.0f,\"pruned\":%llu,\"table_hits\":%llu,\"max_depth\":%u,"
+			"\"covered\":%.4f,\"steals\":%u,\"given\":%u}",
+			k ? "," : "", n, span > 0 ? (n - s->reported) / span : 0.0, t, __atomic_load_n(&s->hits, __ATOMIC_RELAXED),
+			__atomic_load_n(&s->deepest, __ATOMIC_RELAXED),
+			p->free_cells ? (double)(p->free_cells - __atomic_load_n(&s->least, __ATOMIC_RELAXED)) / p->free_cells : 1.0,
+			__atomic_load_n(&s->steals, __ATOMIC_RELAXED), __atomic_load_n(&s->given, __ATOMIC_RELAXED));
+		s->reported = n;
+	}
+	fprintf(stderr, "]}\n");
+	funlockfile(stderr);
+	p->reported = elapsed;
+}
+
+// Wait for the workers to finish, writing a checkpoint and a progress report
+// every so often.
+static void supervise(pool* const p, solver* const selves, checkpoint* const c, options const* const o, struct timespec const* const began)
+{
+	struct timespec save;
+	clock_gettime(CLOCK_REALTIME, &save);
+	struct timespec tell = save;
+	save.tv_sec += o->seconds;
+	tell.tv_sec += o->report;
+	pthread_mutex_lock(&p->lock);
+	while (p->running != 0)
+	{
+		if (p->found)
+		{
+			pthread_cond_wait(&p->settled, &p->lock);
+			continue;
+		}
+		bool const telling = !o->save || (o->report && !earlier(&save, &tell));
+		int        wait    = 0;
+		while (p->running != 0 && wait != ETIMEDOUT) wait = pthread_cond_timedwait(&p->settled, &p->lock, telling ? &tell : &save);
+		if (p->running == 0 || p->found) continue;
+
+		if (telling)
+		{
+			pthread_mutex_unlock(&p->lock);
+			report(p, selves, since(began));
+			tell.tv_sec += o->report;
+			pthread_mutex_lock(&p->lock);
+			continue;
+		}
+
+		__atomic_store_n(&p->pause, true, __ATOMIC_RELAXED);
+		pthread_cond_broadcast(&p->wake);
+		while (p->parked != p->running) pthread_cond_wait(&p->settled, &p->lock);
+		bool ok = capture(p, selves, c);
+		__atomic_store_n(&p->pause, false, __ATOMIC_RELAXED);
+		pthread_cond_broadcast(&p->resume);
+		pthread_mutex_unlock(&p->lock);
+
+		// The table is written as it stands; every entry in it holds.
+		c->slots      = o->with_table ? p->dead.slots : NULL;
+		c->slot_count = table_slots(&p->dead);
+		ok = ok && checkpoint_write(c, o->save);
+		if (!ok) fprintf(stderr, "failed to write checkpoint\n");
+		checkpoint_free(c);
+		clock_gettime(CLOCK_REALTIME, &save);
+		save.tv_sec += o->seconds;
+		pthread_mutex_lock(&p->lock);
+	}
+	pthread_mutex_unlock(&p->lock);
+}
+
+// Search the board in g, with n free cells, and print the solution or "No
+// solution found" to out.  Returns false on an error, once reported.
+static bool solve(options const* const o, grid const* const g, u4 const n, FILE* const out)
+{
+	// Lay the board out with rows as far apart as the pruner's kernels expect.
+	u4 const   w       = pruner_stride(g->w);
+	u4 const   area    = w * g->h;
+	grid       b       = { .w = w, .h = g->h, .cells = calloc(area, 1) };
+	u4 const   workers = o->workers;
+	u4*        starts  = malloc(n * sizeof(*starts) + 1);
+	deque*     deques  = calloc(workers, sizeof(*deques));
+	solver*    selves  = calloc(workers, sizeof(*selves));
+	pthread_t* threads = calloc(workers, sizeof(*threads));
+	char*      text    = NULL;
+	bool       ok      = b.cells && starts && deques && selves && threads;
+	pool       p       =
+	{
+		.lock       = PTHREAD_MUTEX_INITIALIZER,
+		.wake       = PTHREAD_COND_INITIALIZER,
+		.settled    = PTHREAD_COND_INITIALIZER,
+		.resume     = PTHREAD_COND_INITIALIZER,
+		.deques     = deques,
+		.workers    = workers,
+		.starts     = starts,
+		.free_cells = n,
+		.running    = workers,
+	};
+	checkpoint      in = { 0 };
+	checkpoint      snapshot;
+	char            error[ERROR_SIZE];
+	struct timespec began;
+	clock_gettime(CLOCK_MONOTONIC, &began);
+	if (ok)
+	{
+		for (u4 y = 0; y != g->h; ++y) memcpy(b.cells + y * w, g->cells + y * g->w, g->w);
+	}
+	ok = ok && table_init(&p.dead, area, (size_t)o->megabytes << 20);
+	for (u4 k = 0; ok && k != workers; ++k)
+	{
+		solver* const s = &selves[k];
+		s->cells    = malloc(area);
+		s->delta[0] = -1;
+		s->delta[1] = -(s4)w;
+		s->delta[2] = 1;
+		s->delta[3] = w;
+		s->moves    = malloc(n + 1);
+		s->from     = malloc((n + 1) * sizeof(*s->from));
+		s->frames   = malloc((n + 1) * sizeof(*s->frames));
+		s->pool     = &p;
+		s->id       = k;
+		s->least    = n;
+		ok = s->cells && s->moves && s->from && s->frames && pruner_init(&s->prune, s->cells, w, b.h);
+		if (ok) memcpy(s->cells, b.cells, area);
+	}
+	if (ok)
+	{
+		for (u4 i = w; i != area - w; ++i)
+		{
+			if (b.cells[i]) starts[p.start_count++] = i;
+		}
+		ok = rank_starts(&b, g->w, selves[0].delta, starts, p.start_count);
+	}
+	if (!ok)
+	{
+		fprintf(stderr, "out of memory\n");
+		goto done;
+	}
+
+	snapshot = (checkpoint){ g->w, g->h, n, p.start_count, 0, checkpoint_fingerprint(b.cells, area), 0, 0, 0, 0, NULL, 0, NULL, NULL };
+	if (o->save && access(o->save, F_OK) == 0)
+	{
+		if (!checkpoint_read(&in, o->save, error))
+		{
+			fprintf(stderr, "%s\n", error);
+			ok = false;
+			goto done;
+		}
+		if (in.w != snapshot.w || in.h != snapshot.h || in.free_cells != n || in.start_count != p.start_count ||
+				in.board != snapshot.board || in.next_start > p.start_count)
+		{
+			fprintf(stderr, "checkpoint is for another board\n");
+			ok = false;
+			goto done;
+		}
+		for (u4 k = 0; ok && k != in.count; ++k)
+		{
+			ok = walk_valid(b.cells, selves[0].delta, area, n, selves[0].from, &in.walks[k]);
+		}
+		if (!ok)
+		{
+			fprintf(stderr, "invalid checkpoint\n");
+			goto done;
+		}
+		p.next_start     = in.next_start;
+		p.resumes        = in.walks;
+		p.resume_count   = in.count;
+		selves[0].nodes    = in.nodes;
+		selves[0].reported = in.nodes;
+		p.restored         = in.nodes;
+		selves[0].hits     = in.hits;
+		selves[0].stores   = in.stores;
+		if (in.slots && in.slot_count == table_slots(&p.dead))
+		{
+			memcpy(p.dead.slots, in.slots, in.slot_count * sizeof(*in.slots));
+		}
+	}
+
+	// With checkpoints or progress reports this thread keeps time for the
+	// workers.
+	u4 started = 0;
+	if (workers > 1 || o->save || o->report)
+	{
+		for (; started != workers; ++started)
+		{
+			if (pthread_create(&threads[started], NULL, worker_main, &selves[started]) != 0) break;
+		}
+	}
+	pthread_mutex_lock(&p.lock);
+	p.running -= workers - (started ? started : 1);
+	pthread_mutex_unlock(&p.lock);
+	if (started == 0) worker_main(&selves[0]);
+	else if (o->save || o->report) supervise(&p, selves, &snapshot, o, &began);
+	for (u4 k = 0; k != started; ++k) pthread_join(threads[k], NULL);
+	if (o->save) remove(o->save);
+
+	if (o->verbose) report(&p, selves, since(&began));
+
+	solver const* const s = p.winner;
+	text = s ? malloc(s->depth + 1) : NULL;
+	if (!s)
+	{
+		fprintf(out, "No solution found\n");
+	}
+	else if (!text)
+	{
+		fprintf(stderr, "out of memory\n");
+		ok = false;
+	}
+	else
+	{
+		// Replay the solution on the untouched board to compress it.
+		u4         len;
+		bool const compressed = !o->plain && encode_qpath(b.cells, s->delta, s->start, s->moves, s->depth, text, &len);
+		if (!compressed)
+		{
+			for (len = 0; len != s->depth; ++len) text[len] = move_char[s->moves[len]];
+		}
+		fprintf(out, "x=%u&y=%u&%s=%.*s\n", s->start % w - 1, s->start / w - 1, compressed ? "qpath" : "path", (int)len, text);
+	}
+
+done:
+	free(text);
+	for (u4 k = 0; selves && k != workers; ++k)
+	{
+		free(selves[k].cells);
+		free(selves[k].moves);
+		free(selves[k].from);
+		free(selves[k].frames);
+		pruner_free(&selves[k].prune);
+	}
+	for (u4 k = 0; deques && k != workers; ++k) free(deques[k].items);
+	checkpoint_free(&in);
+	table_free(&p.dead);
+	free(starts);
+	free(deques);
+	free(selves);
+	free(threads);
+	free(b.cells);
+	return ok;
+}
+
+// Serve levels framed on standard input, each a line "length=<n>" followed by
+// exactly n bytes of level, until it ends.  Each gets a line "length=<m>" and
+// m bytes of output back, once it has been searched; a level that fails to
+// load or search gets an empty reply.
+static int serve(options const* const o)
+{
+	grid   g      = { 0 };
+	char*  line   = NULL;
+	size_t cap    = 0;
+	char*  level  = NULL;
+	size_t size   = 0;
+	int    status = EXIT_SUCCESS;
+	for (u4 index = 0;; ++index)
+	{
+		ssize_t const len = getline(&line, &cap, stdin);
+		if (len <= 0) break;
+
+		char const* q = line;
+		u4          n;
+		if (!parse_lit(&q, line + len, "length=") || !parse_u4(&q, line + len, &n) || (q != line + len && *q != '\n'))
+		{
+			fprintf(stderr, "could not parse request %u\n", index);
+			status = EXIT_FAILURE;
+			break;
+		}
+		if (n > size)
+		{
+			char* const grown = realloc(level, n);
+			if (!grown)
+			{
+				fprintf(stderr, "out of memory\n");
+				status = EXIT_FAILURE;
+				break;
+			}
+			level = grown;
+			size  = n;
+		}
+		if (fread(level, 1, n, stdin) != n)
+		{
+			fprintf(stderr, "request %u is truncated\n", index);
+			status = EXIT_FAILURE;
+			break;
+		}
+
+		char   error[ERROR_SIZE];
+		char*  text   = NULL;
+		size_t length = 0;
+		FILE*  reply  = open_memstream(&text, &length);
+		u4     free_cells;
+		bool   ok = reply != NULL;
+		if (ok && !level_load(&g, level, level + n, LAYOUT_BYTES, false, &free_cells, error))
+		{
+			fprintf(stderr, "%s\n", error);
+			ok = false;
+		}
+		ok = ok && solve(o, &g, free_cells, reply);
+		if (reply) fclose(reply);
+		if (!ok) length = 0;
+		printf("length=%zu\n", length);
+		fwrite(text, 1, length, stdout);
+		fflush(stdout);
+		free(text);
+	}
+	free(line);
+	free(level);
+	grid_release(&g);
+	return status;
+}
+
+static int usage(char const* const prog)
+{
+	fprintf(stderr,
+		"Usage: %s [-p] [-v] [-s <seconds>] [-j <jobs>] [-m <megabytes>] [-c <checkpoint> [-i <seconds>] [-T]] [<board filename>]\n"
+		"       %s [-p] [-v] [-s <seconds>] [-j <jobs>] [-m <megabytes>] -w\n"
+		"Options:\n"
+		"  -p    Print a path rather than a qpath\n"
+		"  -v    Print search statistics to standard error\n"
+		"  -s    Also print them every this many seconds while searching\n"
+		"  -j    Search on this many threads; 0 for one per core\n"
+		"  -m    Memory for the table of dead states (default %u); 0 for none\n"
+		"  -c    Write checkpoints to this file, and resume from it if it exists\n"
+		"  -i    Seconds between checkpoints (default %u)\n"
+		"  -T    Write the table of dead states into checkpoints, too\n"
+		"  -w    Serve levels framed on standard input, each a line length=<n>\n"
+		"        and n bytes of level, replying in the same framing\n"
+		"Reads the board from standard input if no filename is given.  A level of a\n"
+		"pack written by pack_levels.py is named <pack filename>:<number>.\n",
+		prog, prog, TABLE_MEGABYTES, CHECKPOINT_SECONDS);
+	return EXIT_FAILURE;
+}
+
+int main(int const argc, char** const argv)
+{
+	options o      =
+	{
+		.workers   = 1,
+		.megabytes = TABLE_MEGABYTES,
+		.seconds   = CHECKPOINT_SECONDS,
+	};
+	bool    worker = false;
+	long    jobs;
+	int     opt;
+	while ((opt = getopt(argc, argv, "pvws:j:m:c:i:T")) != -1)
+	{
+		switch (opt)
+		{
+			case 'c':
+				o.save = optarg;
+				break;
+			case 'i':
+				o.seconds = strtol(optarg, NULL, 10);
+				if (o.seconds < 1) o.seconds = 1;
+				break;
+			case 'T':
+				o.with_table = true;
+				break;
+			case 'p':
+				o.plain = true;
+				break;
+			case 'v':
+				o.verbose = true;
+				break;
+			case 's':
+				o.report = strtol(optarg, NULL, 10);
+				if (o.report < 1) o.report = 1;
+				break;
+			case 'w':
+				worker = true;
+				break;
+			case 'm':
+				o.megabytes = strtol(optarg, NULL, 10);
+				if (o.megabytes < 0) o.megabytes = 0;
+				break;
+			case 'j':
+				jobs = strtol(optarg, NULL, 10);
+				if (jobs == 0) jobs = sysconf(_SC_NPROCESSORS_ONLN);
+				if (jobs < 1) jobs = 1;
+				o.workers = jobs;
+				break;
+			default:
+				return usage(argv[0]);
+		}
+	}
+	if (optind + 1 < argc) return usage(argv[0]);
+	if (worker) return optind == argc && !o.save ? serve(&o) : usage(argv[0]);
+	char const* const name = optind < argc ? argv[optind] : "-";
+
+	char error[ERROR_SIZE];
+	grid g = { 0 };
+	u4   n;
+	if (!level_read(&g, name, LAYOUT_BYTES, false, &n, error))
+	{
+		fprintf(stderr, "%s\n", error);
+		return EXIT_FAILURE;
+	}
+	bool const ok = solve(&o, &g, n, stdout);
+	grid_release(&g);
+	return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,110 @@
+#include <stdlib.h>
+
+#include "table.h"
+
+#define WORK_BITS 6
+#define WORK_MASK ((1ull << WORK_BITS) - 1)
+
+static u8 splitmix(u8* const state)
+{
+	u8 z = (*state += 0x9E3779B97F4A7C15ull);
+	z = (z ^ z >> 30) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ z >> 27) * 0x94D049BB133111EBull;
+	return z ^ z >> 31;
+}
+
+// The tag a hash is stored under; never zero, which marks an empty slot.
+static inline u8 tag(u8 const hash)
+{
+	return (hash | 1ull << 63) & ~WORK_MASK;
+}
+
+static inline u8* bucket(table const* const t, u8 const hash)
+{
+	return t->slots + (hash >> WORK_BITS & t->mask) * TABLE_WAYS;
+}
+
+bool table_init(table* const t, u4 const cells, size_t const bytes)
+{
+	t->keys  = malloc((size_t)cells * sizeof(*t->keys) + 1);
+	t->slots = NULL;
+	t->mask  = 0;
+	if (!t->keys) return false;
+	u8 state = 0;
+	for (u4 i = 0; i != cells; ++i) t->keys[i] = splitmix(&state);
+
+	size_t const size = TABLE_WAYS * sizeof(*t->slots);
+	if (bytes < size) return true;
+	u8 buckets = 1;
+	while (buckets * 2 <= bytes / size) buckets *= 2;
+	t->slots = calloc(buckets, size);
+	if (!t->slots)
+	{
+		table_free(t);
+		return false;
+	}
+	t->mask = buckets - 1;
+	return true;
+}
+
+void table_free(table* const t)
+{
+	free(t->keys);
+	free(t->slots);
+	t->keys  = NULL;
+	t->slots = NULL;
+}
+
+bool table_dead(table const* const t, u8 const hash)
+{
+	if (!t->slots) return false;
+	u8 const* const b = bucket(t, hash);
+	u8 const        x = tag(hash);
+	for (u4 k = 0; k != TABLE_WAYS; ++k)
+	{
+		if ((__atomic_load_n(&b[k], __ATOMIC_RELAXED) & ~WORK_MASK) == x) return true;
+	}
+	return false;
+}
+
+bool table_store(table* const t, u8 const hash, u8 const nodes)
+{
+	if (!t->slots) return false;
+	u8 work = 0;
+	while (work != WORK_MASK && nodes >> (work + 1)) ++work;
+
+	u8* const b      = bucket(t, hash);
+	u8 const  x      = tag(hash);
+	u4        victim = 0;
+	u8        least  = WORK_MASK + 1;
+	for (u4 k = 0; k != TABLE_WAYS; ++k)
+	{
+		u8 const slot = __atomic_load_n(&b[k], __ATOMIC_RELAXED);
+		if (slot == 0 || (slot & ~WORK_MASK) == x)
+		{
+			victim = k;
+			least  = 0;
+			break;
+		}
+		if ((slot & WORK_MASK) < least)
+		{
+			victim = k;
+			least  = slot & WORK_MASK;
+		}
+	}
+	if (least > work) return false;
+	__atomic_store_n(&b[victim], x | work, __ATOMIC_RELAXED);
+	return true;
+}
+
+u8 table_occupied(table const* const t)
+{
+	u8 used = 0;
+	for (u8 k = 0; t->slots && k != table_slots(t); ++k) used += __atomic_load_n(&t->slots[k], __ATOMIC_RELAXED) != 0;
+	return used;
+}
+
+u8 table_slots(table const* const t)
+{
+	return t->slots ? (t->mask + 1) * TABLE_WAYS : 0;
+}
@@ -0,0 +1,53 @@
+#ifndef COIL_TABLE_H
+#define COIL_TABLE_H
+
+#include "grid.h"
+
+// Slots per bucket.
+#define TABLE_WAYS 4
+
+// Table of states of the solver's walk from which it cannot be completed,
+// shared by all the workers.  A state is the set of visited cells and the
+// head, and is known by its Zobrist hash: the exclusive or of a random key for
+// every visited cell and another for the head, so a slide updates it from the
+// cells it covers.
+//
+// Each slot holds a hash with its low bits replaced by the rounded log of the
+// work it took to find the state dead.  Slots are read and written a whole
+// word at a time without locks, so a race between two workers just loses one
+// of the entries.  A new entry replaces the cheapest one in its bucket, unless
+// they all took more work.
+typedef struct table
+{
+	u8* keys;  // Key of each cell, for visited cells.
+	u8* slots; // NULL if the table is disabled.
+	u8  mask;  // Buckets less one.
+} table;
+
+// Set up keys for a grid of cells cells and a table of at most bytes bytes,
+// or none if bytes is too small for a single bucket.
+bool table_init(table* t, u4 cells, size_t bytes);
+
+void table_free(table* t);
+
+// Key of the head on cell i.
+static inline u8 table_head(table const* const t, u4 const i)
+{
+	u8 const k = t->keys[i];
+	return k << 29 | k >> 35;
+}
+
+// Whether the state with this hash is known to be dead.
+bool table_dead(table const* t, u8 hash);
+
+// Record the state as dead after nodes nodes of search found it so.  Returns
+// whether it was stored.
+bool table_store(table* t, u8 hash, u8 nodes);
+
+// Slots in use, as far as can be told while the table is being written.
+u8 table_occupied(table const* t);
+
+// Slots in all.
+u8 table_slots(table const* t);
+
+#endif
@@ -3,6 +3,8 @@ import sys
 import argparse
 from collections import deque
 
+from qpath import compress_solution
+
 # Direction vectors: Up, Right, Down, Left
 DIRECTIONS = [(-1, 0), (0, 1), (1, 0), (0, -1)]
 DIRECTION_CHARS = ['U', 'R', 'D', 'L']
@@ -123,6 +125,7 @@ def solve_level(width, height, board):
 def main():
     parser = argparse.ArgumentParser(description='Solve a Coil puzzle using brute force search.')
     parser.add_argument('level_file', nargs='?', help='Path to the level file (optional, reads from stdin if not provided)')
+    parser.add_argument('-p', '--path', action='store_true', help='Print a path rather than a qpath')
     args = parser.parse_args()
     
     # Read the level from file or stdin
@@ -135,8 +138,10 @@ def main():
     # Parse the level
     width, height, board = parse_level(level_str)
     
-    # Solve the level
+    # Solve the level, and leave out the moves the checker makes by itself
     solution = solve_level(width, height, board)
+    if not args.path:
+        solution = compress_solution(level_str, solution)
     
     # Print the solution
     print(solution)
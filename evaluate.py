@@ -1,19 +1,28 @@
 #!/usr/bin/env python3
 import argparse
+import json
 import math
 import os
+import selectors
 import shlex
+import signal
 import subprocess
 import sys
-import tempfile
+import threading
 import time
+from concurrent.futures import ThreadPoolExecutor
+from contextlib import contextmanager
 from dataclasses import dataclass
 from datetime import datetime
 from pathlib import Path
-from typing import Iterable
+from typing import Callable, Iterable
 
 DEFAULT_PUBLIC_LEVELS_DIR = Path("levels_public")
 DEFAULT_RESULTS_PATH = Path("test.md")
+CHECKER_PATH = "./coil_check/check"
+MEASURE_PATH = "./coil_check/measure"
+NO_SOLUTION = "No solution found"
+PIPE_CHUNK = 1 << 16
 TEST_HEADER = [
     "| Date | Model/Solver | Timeout | Highest Passed | Mode | Command |",
     "| --- | --- | --- | --- | --- | --- |",
@@ -53,151 +62,553 @@ def time_to_human_readable(seconds):
 
 
 def estimate_solving_times(level_data):
-    """Estimate solving times for larger levels based on collected data."""
+    """Estimate solving times, and peak memory where it was measured, for larger levels.
+
+    Each entry of level_data is (width, height, seconds, peak RSS in kB or
+    None, search nodes or None).
+    """
+    result = estimate_times(level_data)
+    memory = estimate_peak_memory(level_data)
+    return f"{result}\n\n{memory}" if memory else result
+
+
+def memory_to_human_readable(kilobytes):
+    """Convert a size in kB to a human-readable one."""
+    for unit in ("kB", "MB", "GB"):
+        if kilobytes < 1024:
+            return f"{kilobytes:.1f} {unit}"
+        kilobytes /= 1024
+    return f"{kilobytes:.1f} TB"
+
+
+def estimate_peak_memory(level_data):
+    """Project the solver's peak RSS for larger square levels, or None.
+
+    Peak RSS is fitted as a fixed cost plus a cost per cell, and as a power of
+    the number of cells; the larger projection is the one to plan for.
+    """
+    import numpy as np
+
+    measured = [(level[0] * level[1], level[3]) for level in level_data if len(level) > 3 and level[3]]
+    if len(measured) < 3:
+        return None
+    sizes = np.array([size for size, _ in measured], dtype=float)
+    peaks = np.array([peak for _, peak in measured], dtype=float)
+    if np.ptp(sizes) == 0:
+        return None
+
+    per_cell, fixed = np.polyfit(sizes, peaks, 1)
+    exponent, log_scale = np.polyfit(np.log(sizes), np.log(peaks), 1)
+    lines = []
+    for n in ESTIMATE_SIDES:
+        linear = max(fixed + per_cell * n * n, peaks.max())
+        power = math.exp(log_scale) * (n * n) ** exponent
+        lines.append(f"{n}x{n}: {memory_to_human_readable(linear)} (linear), {memory_to_human_readable(power)} (power)")
+    result = f"Projected peak RSS for square levels ({memory_to_human_readable(fixed)} fixed, "
+    result += f"{per_cell * 1024:.1f} bytes per cell; power {exponent:.2f}):\n"
+    return result + "\n".join(lines)
+
+
+# Square sizes the estimates are given for.
+ESTIMATE_SIDES = [100, 200, 300, 400, 500, 750, 1000, 1500, 2000]
+# Resamples behind each confidence interval.
+BOOTSTRAP_SAMPLES = 1000
+# Times below this are taken as this, so that they have a logarithm.
+MIN_SECONDS = 1e-3
+
+
+@dataclass
+class ScalingModel:
+    """log(y) = intercept + slope * transform(cells), fitted by weighted least squares."""
+
+    name: str
+    transform: object
+
+    def fit(self, np, cells, values, weights):
+        return np.polyfit(self.transform(np, cells), np.log(values), 1, w=np.sqrt(weights))
+
+    def predict(self, np, params, cells):
+        with np.errstate(over="ignore"):
+            return np.exp(params[1] + params[0] * self.transform(np, cells))
+
+    def spread(self, np, params, cells, values, weights) -> float:
+        """Weighted RMS of the log residuals, as a factor: 2.0 means typically off by 2x."""
+        residuals = np.log(values) - np.log(self.predict(np, params, cells))
+        return float(np.exp(np.sqrt(np.sum(weights * residuals**2) / np.sum(weights))))
+
+
+SCALING_MODELS = [
+    ScalingModel("exponential-in-area", lambda np, cells: cells),
+    ScalingModel("polynomial", lambda np, cells: np.log(cells)),
+]
+
+
+def fit_weights(np, cells):
+    """Weights that favour the later, larger levels.
+
+    Levels come in order, so a level's position and its share of the largest
+    area both count: the last and largest level weighs 1.
+    """
+    position = np.arange(1, len(cells) + 1) / len(cells)
+    return position * cells / cells.max()
+
+
+def bootstrap(np, fit, count: int):
+    """Refit on resampled levels; returns the predictions of every refit that
+    had at least two distinct sizes to go on, one row each."""
+    rng = np.random.default_rng(0)
+    rows = []
+    for _ in range(BOOTSTRAP_SAMPLES):
+        sample = rng.integers(0, count, count)
+        row = fit(sample)
+        if row is not None:
+            rows.append(row)
+    return np.array(rows)
+
+
+def estimate_to_human_readable(seconds) -> str:
+    """time_to_human_readable(), but for fits that may run off to infinity."""
+    if not seconds < 3.1536e15:
+        return "over a million millennia"
+    return time_to_human_readable(seconds)
+
+
+def describe_estimates(np, name: str, point, samples) -> str:
+    lines = [f"Using {name} to predict solving times for square levels (90% interval):"]
+    for k, n in enumerate(ESTIMATE_SIDES):
+        estimate = estimate_to_human_readable(float(point[k]))
+        if len(samples):
+            low, high = np.percentile(samples[:, k], [5, 95])
+            interval = f"{estimate_to_human_readable(low)} to {estimate_to_human_readable(high)}"
+            lines.append(f"{n}x{n}: {estimate} ({interval})")
+        else:
+            lines.append(f"{n}x{n}: {estimate}")
+    return "\n".join(lines)
+
+
+def estimate_times(level_data):
+    """Estimate solving times for larger levels based on collected data.
+
+    Each model is fitted in log space, weighted towards the later and larger
+    levels, and its 90% interval comes from refitting on bootstrap resamples
+    of the levels.  Where the solver reported search node counts, the node
+    counts are fitted the same way and turned into time at the observed
+    seconds per node, as a second estimate.
+    """
     try:
         import numpy as np
-        from scipy.optimize import curve_fit
     except Exception as exc:
-        raise RuntimeError("numpy and scipy are required for --estimate") from exc
+        raise RuntimeError("numpy is required for --estimate") from exc
 
     if len(level_data) < 3:
         return "Not enough data to make predictions. Need at least 3 levels."
 
-    # Extract data
-    sizes = np.array([level[0] * level[1] for level in level_data])  # Total cells (width * height)
-    times = np.array([level[2] for level in level_data])  # Solving times
+    cells = np.array([level[0] * level[1] for level in level_data], dtype=float)
+    seconds = np.maximum(np.array([level[2] for level in level_data], dtype=float), MIN_SECONDS)
+    weights = fit_weights(np, cells)
+    targets = np.array([n * n for n in ESTIMATE_SIDES], dtype=float)
+    if np.ptp(cells) == 0:
+        return "Not enough data to make predictions. Need levels of at least two sizes."
+
+    note = "Note: These estimates have significant variance due to the nature of the puzzle-solving algorithm.\n"
+    note += "Different levels of the same size can take vastly different times to solve depending on their structure.\n"
+    note += "The intervals only cover the spread of the levels seen so far, and are likely optimistic."
+    sections = [note]
+
+    for model in SCALING_MODELS:
+        params = model.fit(np, cells, seconds, weights)
+
+        def refit(sample, model=model):
+            if np.ptp(cells[sample]) == 0:
+                return None
+            return model.predict(np, model.fit(np, cells[sample], seconds[sample], weights[sample]), targets)
+
+        spread = model.spread(np, params, cells, seconds, weights)
+        name = f"{model.name} model (typically off by {spread:.1f}x)"
+        sections.append(describe_estimates(np, name, model.predict(np, params, targets), bootstrap(np, refit, len(cells))))
+
+    # Node counts from the solver, where it reported them.
+    counted = [k for k, level in enumerate(level_data) if len(level) > 4 and level[4]]
+    if len(counted) >= 3 and np.ptp(cells[counted]) > 0:
+        node_cells = cells[counted]
+        node_seconds = seconds[counted]
+        nodes = np.array([level_data[k][4] for k in counted], dtype=float)
+        node_weights = fit_weights(np, node_cells)
+        for model in SCALING_MODELS:
+
+            def node_estimate(sample, model=model):
+                if np.ptp(node_cells[sample]) == 0:
+                    return None
+                params = model.fit(np, node_cells[sample], nodes[sample], node_weights[sample])
+                rate = np.sum(node_seconds[sample]) / np.sum(nodes[sample])
+                return model.predict(np, params, targets) * rate
+
+            params = model.fit(np, node_cells, nodes, node_weights)
+            spread = model.spread(np, params, node_cells, nodes, node_weights)
+            name = f"search nodes, {model.name} model (typically off by {spread:.1f}x), at the observed seconds per node"
+            sections.append(
+                describe_estimates(
+                    np, name, node_estimate(np.arange(len(counted))), bootstrap(np, node_estimate, len(counted))
+                )
+            )
 
-    # Check if all times are very similar
-    if np.max(times) - np.min(times) < 0.1:
-        print("Warning: All solving times are very similar. Using calibrated theoretical complexity for estimation.")
+    return "\n\n".join(sections)
 
-        # Calibrate the model based on the observed data.
-        avg_time = np.mean(times)
-        avg_size = np.mean(sizes)
-        coefficient = avg_time / (np.power(avg_size, 2.5) / 1000)
 
-        def theoretical_func(n):
-            return coefficient * np.power(n, 2.5) / 1000
+def search_nodes(stderr: str) -> int | None:
+    """The node count from a JSON statistics line on the solver's stderr,
+    such as the one `coil_check/solve -v` prints, if there is one."""
+    for line in reversed(stderr.splitlines()):
+        line = line.strip()
+        if not line.startswith("{"):
+            continue
+        try:
+            stats = json.loads(line)
+        except ValueError:
+            continue
+        if isinstance(stats, dict) and isinstance(stats.get("nodes"), int):
+            return stats["nodes"]
+    return None
 
-        sizes_to_predict = [n * n for n in [100, 200, 300, 400, 500, 750, 1000, 1500, 2000]]
-        predictions = []
-        for size in sizes_to_predict:
-            n = int(math.sqrt(size))
-            predicted_time = theoretical_func(size)
-            human_time = time_to_human_readable(predicted_time)
-            predictions.append(f"{n}x{n}: {human_time}")
 
-        result = "Using theoretical complexity model to predict solving times for square levels:\n"
-        result += "\n".join(predictions)
-        return result
+@dataclass
+class ResourceUsage:
+    """What a process, or one request to a long-lived one, used."""
+
+    user_seconds: float
+    sys_seconds: float
+    max_rss_kb: int
+    major_faults: int
+    context_switches: int
+
+    @classmethod
+    def from_rusage(cls, usage) -> "ResourceUsage":
+        return cls(
+            user_seconds=usage.ru_utime,
+            sys_seconds=usage.ru_stime,
+            max_rss_kb=usage.ru_maxrss,
+            major_faults=usage.ru_majflt,
+            context_switches=usage.ru_nvcsw + usage.ru_nivcsw,
+        )
+
+    @classmethod
+    def from_json(cls, usage: dict) -> "ResourceUsage":
+        """From the `usage` object of a `check -u` verdict."""
+        return cls(
+            user_seconds=usage["user"],
+            sys_seconds=usage["sys"],
+            max_rss_kb=usage["max_rss_kb"],
+            major_faults=usage["major_faults"],
+            context_switches=usage["context_switches"],
+        )
+
+    def since(self, before: "ResourceUsage") -> "ResourceUsage":
+        """The usage between two readings of the same process."""
+        return ResourceUsage(
+            user_seconds=self.user_seconds - before.user_seconds,
+            sys_seconds=self.sys_seconds - before.sys_seconds,
+            max_rss_kb=self.max_rss_kb,
+            major_faults=self.major_faults - before.major_faults,
+            context_switches=self.context_switches - before.context_switches,
+        )
+
+    def __str__(self) -> str:
+        return (
+            f"{self.user_seconds:.2f}s user, {self.sys_seconds:.2f}s sys, "
+            f"{self.max_rss_kb / 1024:.1f} MB peak RSS, {self.major_faults} major faults, "
+            f"{self.context_switches} context switches"
+        )
+
+
+def describe_usage(solver: ResourceUsage | None, checker: ResourceUsage | None) -> str:
+    parts = []
+    if solver is not None:
+        parts.append(f"solver: {solver}")
+    if checker is not None:
+        parts.append(f"checker: {checker}")
+    return f" [{'; '.join(parts)}]" if parts else ""
+
+
+def rate_to_human_readable(per_second: float) -> str:
+    for unit, scale in (("G", 1e9), ("M", 1e6), ("k", 1e3)):
+        if per_second >= scale:
+            return f"{per_second / scale:.2f}{unit}"
+    return f"{per_second:.0f}"
+
+
+def describe_progress(stats: dict) -> str:
+    """One line for a progress report of `coil_check/solve -s`."""
+    line = (
+        f"{stats['elapsed']:.0f}s: {rate_to_human_readable(stats['nodes_per_second'])} nodes/s, "
+        f"{stats['covered'] * 100:.1f}% covered, max depth {stats['max_depth']}, "
+        f"{stats['table_hit_rate'] * 100:.1f}% table hits, {stats['steals']} steals"
+    )
+    threads = stats.get("threads", [])
+    if len(threads) > 1:
+        rates = [thread["nodes_per_second"] for thread in threads]
+        line += f"; threads {rate_to_human_readable(min(rates))} to {rate_to_human_readable(max(rates))} nodes/s"
+        stalled = [k for k, rate in enumerate(rates) if rate < max(rates) / 10]
+        if stalled:
+            line += f" (stalled: {', '.join(str(k) for k in stalled)})"
+    return line
 
-    # Exponential model: y = a * exp(b * x)
-    def exp_func(x, a, b):
-        return a * np.exp(b * x)
 
-    # Polynomial model: y = a * x^b
-    def poly_func(x, a, b):
-        return a * np.power(x, b)
+class ProgressMonitor:
+    """Shows the periodic statistics lines a solver writes to stderr as they
+    come, and appends them to a JSON lines log with the level number added.
 
-    # Linear model: y = a * x + b
-    def linear_func(x, a, b):
-        return a * x + b
+    Each level's stderr is fed through watch(), in chunks of any size.
+    """
 
-    models = []
-    try:
-        popt_exp, _ = curve_fit(exp_func, sizes, times, maxfev=10000)
-        exp_residuals = np.sum((times - exp_func(sizes, *popt_exp)) ** 2)
-        models.append(("Exponential", popt_exp, exp_func, exp_residuals))
-    except Exception:
-        pass
+    def __init__(self, log_path: Path | None):
+        self.log = log_path.open("a", encoding="utf-8") if log_path else None
+        self.lock = threading.Lock()
 
-    try:
-        popt_poly, _ = curve_fit(poly_func, sizes, times, maxfev=10000)
-        poly_residuals = np.sum((times - poly_func(sizes, *popt_poly)) ** 2)
-        models.append(("Polynomial", popt_poly, poly_func, poly_residuals))
-    except Exception:
-        pass
+    def watch(self, level_num: int):
+        pending = bytearray()
+
+        def feed(data: bytes) -> None:
+            pending.extend(data)
+            while (end := pending.find(b"\n")) >= 0:
+                line = bytes(pending[:end])
+                del pending[: end + 1]
+                self._line(level_num, line)
 
+        return feed
+
+    def _line(self, level_num: int, line: bytes) -> None:
+        try:
+            stats = json.loads(line)
+        except ValueError:
+            return
+        if not isinstance(stats, dict) or "elapsed" not in stats:
+            return
+        with self.lock:
+            try:
+                print(f"\n  Level {level_num} at {describe_progress(stats)}", flush=True)
+            except (KeyError, TypeError):
+                pass
+            if self.log:
+                self.log.write(json.dumps({"level": level_num, **stats}) + "\n")
+                self.log.flush()
+
+    def close(self) -> None:
+        if self.log:
+            self.log.close()
+
+
+class MeasuredPopen(subprocess.Popen):
+    """A child started through coil_check/measure, which reports its peak RSS.
+
+    On Linux a child's ru_maxrss starts at the RSS of the process that forked
+    it, so one forked straight from the harness would report the harness's
+    own size on every small level.  measure forks the command from a small
+    process instead and writes its peak to a pipe.
+    """
+
+    def __init__(self, cmd: list[str], pass_fds: tuple[int, ...] = (), **kwargs):
+        read_fd, write_fd = os.pipe()
+        try:
+            super().__init__([MEASURE_PATH, str(write_fd), *cmd], pass_fds=(*pass_fds, write_fd), **kwargs)
+        except BaseException:
+            os.close(read_fd)
+            raise
+        finally:
+            os.close(write_fd)
+        self.args = cmd
+        self.peak_fd: int | None = read_fd
+
+    def read_peak(self) -> int | None:
+        """The command's peak RSS in kB, once measure has exited."""
+        if self.peak_fd is None:
+            return None
+        with os.fdopen(self.peak_fd, "rb") as pipe:
+            data = pipe.read()
+        self.peak_fd = None
+        return int(data) if data.strip().isdigit() else None
+
+
+def wait_measured(process: subprocess.Popen, timeout: float | None = None) -> ResourceUsage | None:
+    """Reap a child with wait4() and return what it used.
+
+    A child still running after timeout seconds is killed, and
+    subprocess.TimeoutExpired raised once it has been reaped.  A child that
+    has been reaped already gives None.  A MeasuredPopen's peak RSS is the
+    one measure reports.
+    """
+    peak = process.read_peak if isinstance(process, MeasuredPopen) else lambda: None
+    if process.returncode is not None:
+        peak()
+        return None
+    lock = threading.Lock()
+    reaped = False
+    expired = False
+
+    def expire():
+        # Only a child that is still running when the timer fires has
+        # expired: one that exited in time may not have been reaped yet, and
+        # once it has, its pid may belong to another process.
+        nonlocal expired
+        with lock:
+            if reaped:
+                return
+            exited = os.waitid(os.P_PID, process.pid, os.WEXITED | os.WNOHANG | os.WNOWAIT)
+            if exited is None:
+                expired = True
+                process.kill()
+
+    timer = threading.Timer(timeout, expire) if timeout is not None else None
+    if timer:
+        timer.start()
     try:
-        popt_linear, _ = curve_fit(linear_func, sizes, times, maxfev=10000)
-        linear_residuals = np.sum((times - linear_func(sizes, *popt_linear)) ** 2)
-        models.append(("Linear", popt_linear, linear_func, linear_residuals))
-    except Exception:
-        pass
+        _, status, usage = os.wait4(process.pid, 0)
+    finally:
+        with lock:
+            reaped = True
+        if timer:
+            timer.cancel()
+    process.returncode = os.waitstatus_to_exitcode(status)
+    max_rss_kb = peak()
+    # The child can still exit by itself between the check and the kill.
+    if expired and process.returncode == -signal.SIGKILL:
+        raise subprocess.TimeoutExpired(process.args, timeout)
+    measured = ResourceUsage.from_rusage(usage)
+    if max_rss_kb is not None:
+        measured.max_rss_kb = max_rss_kb
+    return measured
+
+
+def process_usage(pid: int) -> ResourceUsage:
+    """What a running process has used so far, from /proc.
+
+    CPU time and faults cover all of its threads; the context switches are
+    those of its main thread.
+    """
+    with open(f"/proc/{pid}/stat", encoding="utf-8") as handle:
+        fields = handle.read().rsplit(")", 1)[1].split()
+    status = {}
+    with open(f"/proc/{pid}/status", encoding="utf-8") as handle:
+        for line in handle:
+            key, _, value = line.partition(":")
+            status[key] = value.split()
+    ticks = os.sysconf("SC_CLK_TCK")
+    return ResourceUsage(
+        user_seconds=int(fields[11]) / ticks,
+        sys_seconds=int(fields[12]) / ticks,
+        max_rss_kb=int(status.get("VmHWM", ["0"])[0]),
+        major_faults=int(fields[9]),
+        context_switches=int(status["voluntary_ctxt_switches"][0]) + int(status["nonvoluntary_ctxt_switches"][0]),
+    )
 
-    if not models:
-        return "Could not fit any model to the data."
 
-    avg_time = np.mean(times)
-    avg_size = np.mean(sizes)
-    coefficient = avg_time / (np.power(avg_size, 2.5) / 1000)
+@dataclass
+class MeasuredRun:
+    stdout: str
+    stderr: str
+    wall_seconds: float
+    usage: ResourceUsage | None
+    timed_out: bool
+    returncode: int
+
+
+def run_measured(
+    cmd: list[str],
+    input_text: str,
+    timeout: float | None,
+    cpus: set[int] | None = None,
+    pass_fds: tuple[int, ...] = (),
+    on_stderr=None,
+) -> MeasuredRun:
+    """Run a command to completion, taking its wall time and resource usage.
+
+    The child is reaped with wait4(), so its usage is its own even while
+    other children run alongside it, and its peak RSS comes from measure.
+    With cpus it is pinned to them.  With on_stderr, it is passed the child's
+    stderr as it comes.
+    """
+    start = time.time()
+    process = MeasuredPopen(
+        cmd,
+        stdin=subprocess.PIPE,
+        stdout=subprocess.PIPE,
+        stderr=subprocess.PIPE,
+        pass_fds=pass_fds,
+        preexec_fn=(lambda: os.sched_setaffinity(0, cpus)) if cpus else None,
+    )
+    outputs = {}
+
+    def feed():
+        try:
+            process.stdin.write(input_text.encode("utf-8"))
+            process.stdin.close()
+        except OSError:
+            pass
+
+    def drain(name, pipe, watch=None):
+        if watch is None:
+            outputs[name] = pipe.read()
+        else:
+            chunks = []
+            for data in iter(lambda: os.read(pipe.fileno(), PIPE_CHUNK), b""):
+                chunks.append(data)
+                watch(data)
+            outputs[name] = b"".join(chunks)
+        pipe.close()
+
+    threads = [
+        threading.Thread(target=feed, daemon=True),
+        threading.Thread(target=drain, args=("stdout", process.stdout), daemon=True),
+        threading.Thread(target=drain, args=("stderr", process.stderr, on_stderr), daemon=True),
+    ]
+    for thread in threads:
+        thread.start()
+    usage = None
+    timed_out = False
+    try:
+        usage = wait_measured(process, timeout)
+    except subprocess.TimeoutExpired:
+        timed_out = True
+    wall_seconds = time.time() - start
+    for thread in threads:
+        thread.join()
+    return MeasuredRun(
+        stdout=outputs.get("stdout", b"").decode("utf-8", "replace"),
+        stderr=outputs.get("stderr", b"").decode("utf-8", "replace"),
+        wall_seconds=wall_seconds,
+        usage=usage,
+        timed_out=timed_out,
+        returncode=process.returncode,
+    )
 
-    def theoretical_func(n):
-        return coefficient * np.power(n, 2.5) / 1000
 
-    models.append(("Theoretical", None, theoretical_func, float("inf")))
+@dataclass(frozen=True)
+class InlineLevel:
+    """A level from outside the level directories, never written to disk.
 
-    sizes_to_predict = [n * n for n in [100, 200, 300, 400, 500, 750, 1000, 1500, 2000]]
-    all_predictions = {}
-    reasonable_models = []
+    Its content comes from load, each time it is asked for, so a level from
+    the secret archive is only decrypted when it runs.
+    """
 
-    for model_name, params, func, _ in models:
-        predictions = []
-        is_reasonable = True
+    name: str
+    load: Callable[[], str]
 
-        for size in sizes_to_predict:
-            n = int(math.sqrt(size))
+    @property
+    def content(self) -> str:
+        return self.load()
 
-            if model_name == "Theoretical":
-                predicted_time = func(size)
-            else:
-                try:
-                    if model_name == "Exponential" and size > 200:
-                        is_reasonable = False
-                        break
-
-                    with np.errstate(all="ignore"):
-                        predicted_time = func(size, *params)
-
-                    if (
-                        np.isinf(predicted_time)
-                        or np.isnan(predicted_time)
-                        or predicted_time < 0
-                        or predicted_time > 31536000000000
-                    ):
-                        is_reasonable = False
-                        break
-                except (OverflowError, FloatingPointError, ValueError, RuntimeWarning):
-                    is_reasonable = False
-                    break
-
-            human_time = time_to_human_readable(predicted_time)
-            predictions.append(f"{n}x{n}: {human_time}")
-
-        if is_reasonable:
-            all_predictions[model_name] = predictions
-            reasonable_models.append(model_name)
-
-    result = "Note: These estimates have significant variance due to the nature of the puzzle-solving algorithm.\n"
-    result += "Different levels of the same size can take vastly different times to solve depending on their structure.\n"
-    result += "The following estimates should be considered rough approximations and likely optimistic.\n\n"
-
-    if not reasonable_models:
-        result += "No models produced reasonable predictions. Using theoretical model only:\n"
-        result += "\n".join(all_predictions["Theoretical"])
-    else:
-        sorted_models = ["Theoretical"] + [m for m in reasonable_models if m != "Theoretical"]
-        for model_name in sorted_models:
-            if model_name in all_predictions:
-                result += f"\nUsing {model_name} model to predict solving times for square levels:\n"
-                result += "\n".join(all_predictions[model_name])
+    def __str__(self) -> str:
+        return self.name
 
-    return result
 
+Level = Path | InlineLevel
 
-def read_level(level_path: Path):
+
+def read_level(level_path: Level):
     """Read a level file and return its contents and dimensions."""
-    content = level_path.read_text(encoding="utf-8").strip()
+    if isinstance(level_path, InlineLevel):
+        content = level_path.content.strip()
+    else:
+        content = level_path.read_text(encoding="utf-8").strip()
 
     parts = content.split("&")
     width = int(parts[0].split("=")[1])
@@ -205,34 +616,446 @@ def read_level(level_path: Path):
     return content, width, height
 
 
-def validate_solution(level_path: Path, solution: str, debug=False):
-    """Validate a solution using the check.c program."""
-    fd, solution_path_str = tempfile.mkstemp(prefix="temp_solution_", suffix=".txt")
-    solution_path = Path(solution_path_str)
-    os.close(fd)
+class BatchChecker:
+    """A long-lived `check -b` process that validates one record per request."""
+
+    def __init__(self, checker: str = CHECKER_PATH):
+        self.checker = checker
+        self.process: subprocess.Popen | None = None
+
+    def _start(self) -> subprocess.Popen:
+        if self.process is None or self.process.poll() is not None:
+            self.process = subprocess.Popen(
+                [self.checker, "-u", "-b"],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.DEVNULL,
+            )
+        return self.process
+
+    def validate(self, level_path: Level, solution: str):
+        process = self._start()
+        payload = solution.encode("utf-8")
+        if isinstance(level_path, InlineLevel):
+            board = level_path.content.encode("utf-8")
+            header = f"length={len(payload)}&boardlength={len(board)}\n".encode("utf-8") + board
+        else:
+            header = f"length={len(payload)}&board={level_path}\n".encode("utf-8")
+        try:
+            process.stdin.write(header + payload)
+            process.stdin.flush()
+            line = process.stdout.readline()
+        except OSError as exc:
+            self.close()
+            return False, str(exc), None
+        if not line:
+            self.close()
+            return False, "checker exited unexpectedly", None
+        verdict = json.loads(line)
+        usage = ResourceUsage.from_json(verdict["usage"]) if "usage" in verdict else None
+        return verdict["ok"], verdict.get("error", ""), usage
+
+    def close(self) -> None:
+        if self.process is None:
+            return
+        if self.process.stdin:
+            self.process.stdin.close()
+        self.process.wait()
+        self.process = None
+
+
+@contextmanager
+def board_argument(level_path: Level):
+    """Yield the checker's board argument and the descriptors it needs.
+
+    A level held in memory is fed to the checker through a pipe, as
+    /dev/fd/<n>, so that it never touches the disk.
+    """
+    if not isinstance(level_path, InlineLevel):
+        yield str(level_path), ()
+        return
+
+    read_fd, write_fd = os.pipe()
+
+    def feed():
+        try:
+            with os.fdopen(write_fd, "wb") as pipe:
+                pipe.write(level_path.content.encode("utf-8"))
+        except OSError:
+            pass
+
+    feeder = threading.Thread(target=feed, daemon=True)
+    feeder.start()
+    try:
+        yield f"/dev/fd/{read_fd}", (read_fd,)
+    finally:
+        os.close(read_fd)
+        feeder.join(timeout=1)
+
+
+def validate_solution(level_path: Level, solution: str, debug=False, checker: BatchChecker | None = None):
+    """Validate a solution using the check.c program.
+
+    Returns whether it is valid, the error if not, and what checking used.
+    """
+    if checker is not None and not debug:
+        return checker.validate(level_path, solution)
 
     try:
-        solution_path.write_text(solution, encoding="utf-8")
-        cmd = ["./coil_check/check"]
+        cmd = [CHECKER_PATH]
         if debug:
             cmd.append("-d")
-        cmd.extend([str(level_path), str(solution_path)])
-
-        result = subprocess.run(cmd, capture_output=True, text=True, check=False)
-        return result.returncode == 0, result.stderr if result.returncode != 0 else ""
+        with board_argument(level_path) as (board, fds):
+            cmd.extend([board, "-"])
+            result = run_measured(cmd, solution, None, pass_fds=fds)
+        return result.returncode == 0, result.stderr if result.returncode != 0 else "", result.usage
     except Exception as exc:
-        return False, str(exc)
+        return False, str(exc), None
+
+
+@dataclass
+class SolverRun:
+    time_taken: float
+    valid: bool = False
+    no_solution: bool = False
+    error: str = ""
+    stderr: str = ""
+    stopped_early: bool = False
+    solver_usage: ResourceUsage | None = None
+    checker_usage: ResourceUsage | None = None
+
+
+def run_solver(
+    solver: list[str], level_content: str, level_path: Level, timeout: float, debug: bool, checker, watch=None
+) -> SolverRun:
+    """Run the solver to completion, then validate its output."""
+    process = run_measured(solver, level_content, timeout, on_stderr=watch)
+    if process.timed_out:
+        raise subprocess.TimeoutExpired(solver, timeout)
+    solution = process.stdout.strip()
+    run = SolverRun(time_taken=process.wall_seconds, stderr=process.stderr, solver_usage=process.usage)
+
+    if solution == NO_SOLUTION:
+        run.no_solution = True
+        return run
+
+    run.valid, run.error, run.checker_usage = validate_solution(level_path, solution, debug, checker)
+    return run
+
+
+class SolverWorker:
+    """A long-lived solver, started with `-w`, that solves one level per request.
+
+    Each request is a line `length=<n>` followed by n bytes of level, and each
+    reply a line `length=<m>` followed by m bytes of what the solver would
+    have printed for that level.  Timing is taken around each request, so the
+    solver's own start-up is paid once instead of on every level.
+    """
+
+    def __init__(self, solver: list[str]):
+        self.solver = solver
+        self.process: subprocess.Popen | None = None
+        self.stderr = bytearray()
+        self.stderr_lock = threading.Lock()
+        self.watch = None  # Passed the stderr of the request in hand.
+
+    def _start(self) -> subprocess.Popen:
+        if self.process is None or self.process.poll() is not None:
+            self.process = subprocess.Popen(
+                [*self.solver, "-w"],
+                stdin=subprocess.PIPE,
+                stdout=subprocess.PIPE,
+                stderr=subprocess.PIPE,
+            )
+            threading.Thread(target=self._drain_stderr, args=(self.process.stderr,), daemon=True).start()
+        return self.process
+
+    def _drain_stderr(self, pipe) -> None:
+        for data in iter(lambda: os.read(pipe.fileno(), PIPE_CHUNK), b""):
+            with self.stderr_lock:
+                self.stderr += data
+                if self.watch is not None:
+                    self.watch(data)
+
+    def take_stderr(self) -> str:
+        with self.stderr_lock:
+            text = self.stderr.decode("utf-8", "replace")
+            self.stderr.clear()
+        return text
+
+    def _read(self, deadline: float, predicate) -> bytes:
+        """Read the reply until predicate(data) gives the length wanted."""
+        data = bytearray()
+        fd = self.process.stdout.fileno()
+        with selectors.DefaultSelector() as sel:
+            sel.register(fd, selectors.EVENT_READ)
+            while (wanted := predicate(data)) is None or len(data) < wanted:
+                remaining = deadline - time.time()
+                if remaining <= 0 or not sel.select(remaining):
+                    self.close(kill=True)
+                    raise subprocess.TimeoutExpired([*self.solver, "-w"], 0)
+                chunk = os.read(fd, PIPE_CHUNK)
+                if not chunk:
+                    self.close(kill=True)
+                    raise RuntimeError("solver worker exited unexpectedly")
+                data += chunk
+        return bytes(data)
+
+    def solve(self, level_content: str, timeout: float) -> tuple[str, float]:
+        """Send a level and return the solver's reply and the time it took."""
+        process = self._start()
+        payload = level_content.encode("utf-8")
+        start = time.time()
+        deadline = start + timeout
+        try:
+            process.stdin.write(f"length={len(payload)}\n".encode("utf-8") + payload)
+            process.stdin.flush()
+        except OSError as exc:
+            self.close(kill=True)
+            raise RuntimeError("solver worker exited unexpectedly") from exc
+
+        def header_end(data: bytearray) -> int | None:
+            end = data.find(b"\n")
+            return None if end < 0 else end + 1
+
+        def reply_end(data: bytearray) -> int | None:
+            end = header_end(data)
+            if end is None:
+                return None
+            header = bytes(data[:end]).strip()
+            if not header.startswith(b"length=") or not header[7:].isdigit():
+                raise RuntimeError(f"solver worker sent an invalid reply header: {header!r}")
+            return end + int(header[7:])
+
+        reply = self._read(deadline, reply_end)
+        elapsed = time.time() - start
+        return reply[header_end(reply):].decode("utf-8", "replace"), elapsed
+
+    def usage(self) -> ResourceUsage | None:
+        """What the worker has used so far, if it can be read."""
+        try:
+            return process_usage(self._start().pid)
+        except (OSError, KeyError, IndexError, ValueError):
+            return None
+
+    def close(self, kill: bool = False) -> None:
+        if self.process is None:
+            return
+        if kill and self.process.poll() is None:
+            self.process.kill()
+        if self.process.stdin:
+            try:
+                self.process.stdin.close()
+            except OSError:
+                pass
+        self.process.wait()
+        self.process = None
+
+
+def run_solver_worker(
+    worker: SolverWorker, level_content: str, level_path: Level, timeout: float, debug: bool, checker, watch=None
+) -> SolverRun:
+    """Have a long-lived solver solve the level, then validate its output.
+
+    The solver's usage is the difference in what the worker had used before
+    and after the request; its peak RSS is the worker's over its lifetime.
+    """
+    before = worker.usage()
+    with worker.stderr_lock:
+        worker.watch = watch
+    try:
+        output, time_taken = worker.solve(level_content, timeout)
+    except subprocess.TimeoutExpired:
+        raise subprocess.TimeoutExpired([*worker.solver, "-w"], timeout) from None
     finally:
-        if solution_path.exists():
-            solution_path.unlink()
+        with worker.stderr_lock:
+            worker.watch = None
+    after = worker.usage()
+    solution = output.strip()
+    run = SolverRun(
+        time_taken=time_taken,
+        stderr=worker.take_stderr(),
+        solver_usage=after.since(before) if before and after else None,
+    )
+
+    if solution == NO_SOLUTION:
+        run.no_solution = True
+        return run
+
+    run.valid, run.error, run.checker_usage = validate_solution(level_path, solution, debug, checker)
+    return run
+
+
+def run_solver_pipelined(
+    solver: list[str], level_content: str, level_path: Level, timeout: float, debug: bool, watch=None
+) -> SolverRun:
+    with board_argument(level_path) as (board, fds):
+        return _run_solver_pipelined(solver, level_content, board, fds, timeout, debug, watch)
+
+
+def _run_solver_pipelined(
+    solver: list[str], level_content: str, board: str, fds: tuple[int, ...], timeout: float, debug: bool, watch=None
+) -> SolverRun:
+    """Run the solver with its stdout relayed into a streaming checker.
+
+    The checker decodes the solution while the solver is still writing it. If
+    it finds an invalid move, the solver is killed right away instead of being
+    left to run to completion or to the timeout.
+    """
+    level_start = time.time()
+    deadline = level_start + timeout
+    checker_cmd = [CHECKER_PATH] + (["-d"] if debug else []) + [board, "-"]
+    solver_proc = MeasuredPopen(solver, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+    checker_proc = MeasuredPopen(
+        checker_cmd, stdin=subprocess.PIPE, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE, pass_fds=fds
+    )
+
+    # Feed the level from a thread, in case the solver starts writing before
+    # it has read all of its input.
+    def feed_level():
+        try:
+            solver_proc.stdin.write(level_content.encode("utf-8"))
+            solver_proc.stdin.close()
+        except OSError:
+            pass
+
+    feeder = threading.Thread(target=feed_level, daemon=True)
+    feeder.start()
+
+    solver_stderr = bytearray()
+    checker_stderr = bytearray()
+    checker_usage = None
+
+    def reap_checker() -> int:
+        nonlocal checker_usage
+        if checker_proc.returncode is None:
+            checker_usage = wait_measured(checker_proc)
+        return checker_proc.returncode
+
+    # Output is held back while it could still be the "No solution found"
+    # marker, or is only leading white space.
+    held = bytearray()
+    forwarding = True
+    holding = True
+    checker_done = False
+    sel = selectors.DefaultSelector()
+    sel.register(solver_proc.stdout, selectors.EVENT_READ, "stdout")
+    sel.register(solver_proc.stderr, selectors.EVENT_READ, "stderr")
+    sel.register(checker_proc.stderr, selectors.EVENT_READ, "checker")
+
+    def forward(data: bytes) -> None:
+        nonlocal forwarding
+        if not forwarding or not data:
+            return
+        try:
+            checker_proc.stdin.write(data)
+            checker_proc.stdin.flush()
+        except OSError:
+            # The checker has made up its mind and stopped reading.
+            forwarding = False
+
+    def stop_forwarding() -> None:
+        nonlocal forwarding
+        forwarding = False
+        try:
+            checker_proc.stdin.close()
+        except OSError:
+            pass
+
+    def kill_all() -> None:
+        for proc in (solver_proc, checker_proc):
+            if proc.poll() is None:
+                proc.kill()
+            proc.wait()
+            proc.read_peak()
+
+    try:
+        while sel.get_map():
+            remaining = deadline - time.time()
+            if remaining <= 0:
+                kill_all()
+                raise subprocess.TimeoutExpired(solver, timeout)
+
+            for key, _ in sel.select(remaining):
+                data = os.read(key.fileobj.fileno(), PIPE_CHUNK)
+                if key.data == "stderr":
+                    solver_stderr += data
+                    if watch is not None:
+                        watch(data)
+                elif key.data == "checker":
+                    checker_stderr += data
+                    if not data:
+                        checker_done = True
+                elif holding and data:
+                    held += data
+                    text = bytes(held).lstrip()
+                    if text and not NO_SOLUTION.encode().startswith(text[: len(NO_SOLUTION)]):
+                        holding = False
+                        forward(text)
+                        held.clear()
+                elif data:
+                    forward(data)
+                else:
+                    # The solver closed its output.
+                    if holding and bytes(held).strip() == NO_SOLUTION.encode():
+                        kill_all()
+                        return SolverRun(
+                            time_taken=time.time() - level_start,
+                            no_solution=True,
+                            stderr=solver_stderr.decode("utf-8", "replace"),
+                        )
+                    if holding:
+                        forward(bytes(held).lstrip())
+                    stop_forwarding()
+                if not data:
+                    sel.unregister(key.fileobj)
+
+            if checker_done and reap_checker() != 0 and solver_proc.poll() is None:
+                # Invalid prefix: no point letting the solver carry on.
+                kill_all()
+                return SolverRun(
+                    time_taken=time.time() - level_start,
+                    error=checker_stderr.decode("utf-8", "replace"),
+                    stderr=solver_stderr.decode("utf-8", "replace"),
+                    stopped_early=True,
+                )
+
+        remaining = deadline - time.time()
+        try:
+            solver_usage = wait_measured(solver_proc, timeout=max(remaining, 0))
+        except subprocess.TimeoutExpired:
+            kill_all()
+            raise subprocess.TimeoutExpired(solver, timeout) from None
+        time_taken = time.time() - level_start
+        checker_code = reap_checker()
+    finally:
+        sel.close()
+        feeder.join(timeout=1)
+
+    return SolverRun(
+        time_taken=time_taken,
+        valid=checker_code == 0,
+        error="" if checker_code == 0 else checker_stderr.decode("utf-8", "replace"),
+        stderr=solver_stderr.decode("utf-8", "replace"),
+        solver_usage=solver_usage,
+        checker_usage=checker_usage,
+    )
 
 
 def _level_number(path: Path) -> int | None:
     return int(path.name) if path.name.isdigit() else None
 
 
-def collect_level_files(level_dirs: Iterable[Path], start: int, end: int | None) -> list[tuple[int, Path]]:
-    selected: dict[int, Path] = {}
+def collect_level_files(
+    level_dirs: Iterable[Path],
+    start: int,
+    end: int | None,
+    inline_levels: dict[int, InlineLevel] | None = None,
+) -> list[tuple[int, Level]]:
+    selected: dict[int, Level] = {}
+    for level_num, level in (inline_levels or {}).items():
+        if start <= level_num and (end is None or level_num <= end):
+            selected[level_num] = level
     for level_dir in level_dirs:
         if not level_dir.exists() or not level_dir.is_dir():
             continue
@@ -300,50 +1123,57 @@ def append_test_result_row(
 
 def run_evaluation(
     *,
-    solver: str,
-    level_files: list[tuple[int, Path]],
+    solver: list[str],
+    level_files: list[tuple[int, Level]],
     timeout: float,
     estimate: bool,
     debug: bool,
+    pipeline: bool = False,
+    worker: bool = False,
+    monitor: ProgressMonitor | None = None,
 ) -> EvaluationSummary:
     run_start = time.time()
     highest_passed = 0
     level_data = []
     stop_reason = "COMPLETE"
+    checker = BatchChecker()
+    solver_worker = SolverWorker(solver) if worker else None
 
     for level_num, level_path in level_files:
         level_content, width, height = read_level(level_path)
         print(f"Level {level_num} ({width}x{height}): ", end="", flush=True)
 
         level_start = time.time()
+        watch = monitor.watch(level_num) if monitor else None
 
         try:
-            process = subprocess.run(
-                [solver],
-                input=level_content,
-                capture_output=True,
-                text=True,
-                timeout=timeout,
-            )
-            solution = process.stdout.strip()
-            time_taken = time.time() - level_start
+            if solver_worker is not None:
+                run = run_solver_worker(solver_worker, level_content, level_path, timeout, debug, checker, watch)
+            elif pipeline:
+                run = run_solver_pipelined(solver, level_content, level_path, timeout, debug, watch)
+            else:
+                run = run_solver(solver, level_content, level_path, timeout, debug, checker, watch)
+            time_taken = run.time_taken
+            usage = describe_usage(run.solver_usage, run.checker_usage)
 
-            if solution == "No solution found":
-                print(f"FAIL (No solution found) ({time_taken:.2f}s)")
+            if run.no_solution:
+                print(f"FAIL (No solution found) ({time_taken:.2f}s){usage}")
                 stop_reason = "FAIL"
                 break
 
-            is_valid, error_msg = validate_solution(level_path, solution, debug)
-            if is_valid:
-                print(f"PASS ({time_taken:.2f}s)")
+            if run.valid:
+                print(f"PASS ({time_taken:.2f}s){usage}")
                 highest_passed = level_num
-                level_data.append((width, height, time_taken))
+                level_data.append(level_record(width, height, time_taken, run.solver_usage, run.stderr))
             else:
-                print(f"FAIL ({time_taken:.2f}s)")
-                if error_msg:
-                    print(f"  Error: {error_msg}")
-                if process.stderr:
-                    print(f"  Solver stderr: {process.stderr}")
+                if run.stopped_early:
+                    print(f"FAIL ({time_taken:.2f}s, solver stopped at first invalid move){usage}")
+                else:
+                    print(f"FAIL ({time_taken:.2f}s){usage}")
+                if run.error:
+                    print(f"  Error: {run.error}")
+                if run.stderr:
+                    print(f"  Solver stderr: {run.stderr}")
                 stop_reason = "FAIL"
                 break
 
@@ -358,24 +1188,128 @@ def run_evaluation(
             stop_reason = "ERROR"
             break
 
-    estimate_output = None
-    if estimate and level_data:
-        try:
-            print("\nEstimating solving times for larger levels...")
-            estimate_output = estimate_solving_times(level_data)
-            print(estimate_output)
-        except Exception as exc:
-            print(f"\nError estimating solving times: {exc}")
-            print("Make sure numpy and scipy are installed:")
-            print("pip install numpy scipy")
-            estimate_output = f"estimate-error: {exc}"
+    checker.close()
+    if solver_worker is not None:
+        solver_worker.close()
 
     return EvaluationSummary(
         highest_passed=highest_passed,
         total_levels=len(level_files),
         elapsed_seconds=time.time() - run_start,
         stop_reason=stop_reason,
-        estimate_output=estimate_output,
+        estimate_output=run_estimate(level_data) if estimate else None,
+    )
+
+
+def level_record(width: int, height: int, time_taken: float, usage: ResourceUsage | None, stderr: str = ""):
+    """An entry of the data estimate_solving_times() fits."""
+    return (width, height, time_taken, usage.max_rss_kb if usage else None, search_nodes(stderr))
+
+
+def run_estimate(level_data) -> str | None:
+    """Print and return the estimate for the levels passed, if there are any."""
+    if not level_data:
+        return None
+    try:
+        print("\nEstimating solving times for larger levels...")
+        estimate_output = estimate_solving_times(level_data)
+        print(estimate_output)
+    except Exception as exc:
+        print(f"\nError estimating solving times: {exc}")
+        print("Make sure numpy is installed:")
+        print("pip install numpy")
+        estimate_output = f"estimate-error: {exc}"
+    return estimate_output
+
+
+def core_sets(jobs: int) -> list[set[int]]:
+    """Split the CPUs this process may run on into one set per job."""
+    cpus = sorted(os.sched_getaffinity(0))
+    if jobs >= len(cpus):
+        return [{cpus[k % len(cpus)]} for k in range(jobs)]
+    return [set(cpus[k * len(cpus) // jobs : (k + 1) * len(cpus) // jobs]) for k in range(jobs)]
+
+
+def run_evaluation_concurrent(
+    *,
+    solver: list[str],
+    level_files: list[tuple[int, Level]],
+    timeout: float,
+    estimate: bool,
+    debug: bool,
+    jobs: int,
+    monitor: ProgressMonitor | None = None,
+) -> EvaluationSummary:
+    """Run every level, jobs at a time, each solver pinned to its own cores.
+
+    This is for throughput, not scoring: it does not stop at the first
+    failure.  The highest level passed is still the last one of the unbroken
+    run of passes from the first level, as in a sequential evaluation.
+    """
+    run_start = time.time()
+    checker = BatchChecker()
+    checker_lock = threading.Lock()
+    free_sets = list(core_sets(jobs))
+    sets_lock = threading.Lock()
+    print_lock = threading.Lock()
+
+    def run_level(level_num: int, level_path: Level):
+        level_content, width, height = read_level(level_path)
+        with sets_lock:
+            cpus = free_sets.pop()
+        try:
+            run = run_measured(solver, level_content, timeout, cpus, on_stderr=monitor.watch(level_num) if monitor else None)
+        finally:
+            with sets_lock:
+                free_sets.append(cpus)
+
+        solution = run.stdout.strip()
+        times = f"{run.wall_seconds:.2f}s"
+        error = ""
+        checker_usage = None
+        if run.timed_out:
+            verdict = f"TIMEOUT - Exceeded {timeout}s limit ({times})"
+        elif solution == NO_SOLUTION:
+            verdict = f"FAIL (No solution found) ({times})"
+        else:
+            with checker_lock:
+                valid, error, checker_usage = validate_solution(level_path, solution, debug, checker)
+            verdict = f"PASS ({times})" if valid else f"FAIL ({times})"
+        passed = verdict.startswith("PASS")
+        with print_lock:
+            print(f"Level {level_num} ({width}x{height}): {verdict}{describe_usage(run.usage, checker_usage)}", flush=True)
+            if not passed and error:
+                print(f"  Error: {error}")
+            if not passed and run.stderr:
+                print(f"  Solver stderr: {run.stderr}")
+        return passed, level_record(width, height, run.wall_seconds, run.usage, run.stderr)
+
+    with ThreadPoolExecutor(max_workers=jobs) as executor:
+        futures = [executor.submit(run_level, level_num, level_path) for level_num, level_path in level_files]
+        results = []
+        for (level_num, _), future in zip(level_files, futures):
+            try:
+                results.append((level_num, *future.result()))
+            except Exception as exc:
+                print(f"Level {level_num}: ERROR: {exc}")
+                results.append((level_num, False, None))
+    checker.close()
+
+    highest_passed = 0
+    for level_num, passed, _ in results:
+        if not passed:
+            break
+        highest_passed = level_num
+    failures = sum(1 for _, passed, _ in results if not passed)
+    print(f"\nPassed {len(results) - failures} of {len(results)} levels")
+    level_data = [data for _, passed, data in results if passed]
+
+    return EvaluationSummary(
+        highest_passed=highest_passed,
+        total_levels=len(level_files),
+        elapsed_seconds=time.time() - run_start,
+        stop_reason="COMPLETE" if failures == 0 else "FAIL",
+        estimate_output=run_estimate(level_data) if estimate else None,
     )
 
 
@@ -401,6 +1335,40 @@ def build_argument_parser(description: str) -> argparse.ArgumentParser:
         action="store_true",
         help="Enable debug mode for solution validation",
     )
+    modes = parser.add_mutually_exclusive_group()
+    modes.add_argument(
+        "--pipeline",
+        action="store_true",
+        help="Validate solver output while it is written and stop the solver at the first invalid move",
+    )
+    parser.add_argument(
+        "--jobs",
+        type=int,
+        default=1,
+        help="Run this many levels at once, each solver pinned to its own cores, without stopping at a failure",
+    )
+    modes.add_argument(
+        "--worker",
+        action="store_true",
+        help="Start the solver once with -w and send it every level over its standard input",
+    )
+    parser.add_argument(
+        "--nodes",
+        action="store_true",
+        help="Run the solver with -v and let --estimate fit the search node counts it reports",
+    )
+    parser.add_argument(
+        "--progress",
+        type=int,
+        metavar="SECONDS",
+        help="Run the solver with -s SECONDS and show the statistics it reports while it searches",
+    )
+    parser.add_argument(
+        "--progress-log",
+        type=Path,
+        metavar="PATH",
+        help="Append the solver's progress reports to this JSON lines file",
+    )
     return parser
 
 
@@ -413,12 +1381,19 @@ def evaluate_and_log(
     estimate: bool,
     debug: bool,
     level_dirs: Iterable[Path],
+    inline_levels: dict[int, InlineLevel] | None = None,
+    pipeline: bool = False,
+    worker: bool = False,
+    jobs: int = 1,
+    nodes: bool = False,
+    progress: int | None = None,
+    progress_log: Path | None = None,
     mode: str,
     invocation_argv: list[str],
     results_path: Path = DEFAULT_RESULTS_PATH,
 ) -> int:
     try:
-        level_files = collect_level_files(level_dirs, start=start, end=end)
+        level_files = collect_level_files(level_dirs, start=start, end=end, inline_levels=inline_levels)
     except ValueError as exc:
         print(exc)
         return 1
@@ -427,13 +1402,42 @@ def evaluate_and_log(
         print(f"No levels found between {start} and {end or 'end'}")
         return 1
 
-    summary = run_evaluation(
-        solver=solver,
-        level_files=level_files,
-        timeout=timeout,
-        estimate=estimate,
-        debug=debug,
-    )
+    if jobs > 1 and (pipeline or worker):
+        print("--jobs cannot be combined with --pipeline or --worker")
+        return 1
+    if progress_log is not None and progress is None:
+        print("--progress-log needs --progress")
+        return 1
+
+    command = [solver, "-v"] if nodes else [solver]
+    monitor = None
+    if progress is not None:
+        command += ["-s", str(progress)]
+        monitor = ProgressMonitor(progress_log)
+    if jobs > 1:
+        summary = run_evaluation_concurrent(
+            solver=command,
+            level_files=level_files,
+            timeout=timeout,
+            estimate=estimate,
+            debug=debug,
+            jobs=jobs,
+            monitor=monitor,
+        )
+        mode = f"{mode}-jobs{jobs}"
+    else:
+        summary = run_evaluation(
+            solver=command,
+            level_files=level_files,
+            timeout=timeout,
+            estimate=estimate,
+            debug=debug,
+            pipeline=pipeline,
+            worker=worker,
+            monitor=monitor,
+        )
+    if monitor is not None:
+        monitor.close()
     append_test_result_row(
         results_path=results_path,
         solver=solver,
@@ -457,6 +1461,12 @@ def main() -> int:
         estimate=args.estimate,
         debug=args.debug,
         level_dirs=[DEFAULT_PUBLIC_LEVELS_DIR],
+        pipeline=args.pipeline,
+        worker=args.worker,
+        jobs=args.jobs,
+        nodes=args.nodes,
+        progress=args.progress,
+        progress_log=args.progress_log,
         mode="dev-odd",
         invocation_argv=sys.argv,
     )
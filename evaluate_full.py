@@ -3,7 +3,9 @@ import shutil
 import subprocess
 import sys
 import tarfile
-import tempfile
+import threading
+from contextlib import closing
+from functools import partial
 from getpass import getpass
 from pathlib import Path
 
@@ -11,42 +13,122 @@ import evaluate
 
 DEFAULT_SECRET_ARCHIVE = Path("levels_secret_even.tar.enc")
 DEFAULT_PUBLIC_LEVELS_DIR = Path("levels_public")
+BATCH_BYTES = 64 << 20
+DECRYPT_ERROR = "Failed to decrypt even-level archive (wrong password or corrupt archive)."
+
+
+class SecretArchive:
+    """The even levels of the encrypted archive, decrypted in batches as they run.
+
+    Nothing is written to disk.  Opening the archive streams through it once
+    and notes the name and size of each level from start to end.  A level
+    that is asked for is read by decrypting the stream again, together with
+    the levels that follow it in number, up to BATCH_BYTES of them, so that
+    the batch is ready for the levels that run next.
+    """
+
+    def __init__(self, path: Path, password: str, start: int, end: int | None):
+        self.path = path
+        self.password = password
+        self.lock = threading.Lock()
+        self.sizes: dict[int, int] = {}
+        self.batch: dict[int, str] = {}
+
+        members: dict[int, str] = {}
+        with closing(self._levels(start, end)) as levels:
+            for level_num, member in levels:
+                if level_num in members:
+                    raise RuntimeError(
+                        f"Duplicate level number {level_num} found: {members[level_num]} and {member.name}"
+                    )
+                members[level_num] = member.name
+                self.sizes[level_num] = member.size
+
+    def levels(self) -> dict[int, evaluate.InlineLevel]:
+        return {
+            level_num: evaluate.InlineLevel(f"{self.path.name}:{level_num}", partial(self.read, level_num))
+            for level_num in self.sizes
+        }
+
+    def read(self, level_num: int) -> str:
+        with self.lock:
+            if level_num not in self.batch:
+                wanted = set()
+                size = 0
+                for number in sorted(self.sizes):
+                    if number < level_num:
+                        continue
+                    if wanted and size + self.sizes[number] > BATCH_BYTES:
+                        break
+                    wanted.add(number)
+                    size += self.sizes[number]
+                self.batch = {}
+                with closing(self._levels(level_num, max(wanted), wanted)) as batch:
+                    for number, content in batch:
+                        self.batch[number] = content
+                if level_num not in self.batch:
+                    raise RuntimeError(DECRYPT_ERROR)
+            return self.batch[level_num]
+
+    def _levels(self, start: int, end: int | None, wanted: set[int] | None = None):
+        """Decrypt the archive and yield the levels from start to end.
+
+        Without wanted each comes as its tar member, and the whole stream is
+        read, so that a wrong password shows in openssl's exit status.  With
+        wanted the content of each such level comes instead, and decryption
+        stops once it has them all.
+        """
+        cmd = [
+            "openssl",
+            "enc",
+            "-d",
+            "-aes-256-cbc",
+            "-pbkdf2",
+            "-salt",
+            "-pass",
+            "stdin",
+            "-in",
+            str(self.path),
+        ]
+        process = subprocess.Popen(cmd, stdin=subprocess.PIPE, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+        try:
+            process.stdin.write(f"{self.password}\n".encode("utf-8"))
+            process.stdin.close()
+        except OSError:
+            pass
 
-
-def decrypt_secret_archive(secret_archive: Path, password: str, output_tar: Path) -> None:
-    cmd = [
-        "openssl",
-        "enc",
-        "-d",
-        "-aes-256-cbc",
-        "-pbkdf2",
-        "-salt",
-        "-pass",
-        "stdin",
-        "-in",
-        str(secret_archive),
-        "-out",
-        str(output_tar),
-    ]
-    result = subprocess.run(
-        cmd,
-        input=f"{password}\n",
-        capture_output=True,
-        text=True,
-        check=False,
-    )
-    if result.returncode != 0:
-        raise RuntimeError("Failed to decrypt even-level archive (wrong password or corrupt archive).")
-
-
-def safe_extract_tar(archive_path: Path, destination_dir: Path) -> None:
-    dest_root = destination_dir.resolve()
-    with tarfile.open(archive_path, "r") as archive:
-        for member in archive.getmembers():
-            target = (destination_dir / member.name).resolve()
-            if target != dest_root and dest_root not in target.parents:
-                raise RuntimeError("Secret archive contains unsafe paths.")
-        archive.extractall(destination_dir)
+        left = set(wanted) if wanted is not None else None
+        finished = False
+        try:
+            with tarfile.open(fileobj=process.stdout, mode="r|") as archive:
+                for member in archive:
+                    name = Path(member.name).name
+                    if not member.isfile() or not name.isdigit():
+                        continue
+                    level_num = int(name)
+                    if level_num < start or (end is not None and level_num > end):
+                        continue
+                    if left is None:
+                        yield level_num, member
+                    elif level_num in left:
+                        left.discard(level_num)
+                        yield level_num, archive.extractfile(member).read().decode("utf-8")
+                        if not left:
+                            break
+            if left is None:
+                # A wrong password can show only at the end, in the padding.
+                for _ in iter(lambda: process.stdout.read(evaluate.PIPE_CHUNK), b""):
+                    pass
+                finished = True
+        except (tarfile.TarError, UnicodeDecodeError) as exc:
+            raise RuntimeError(DECRYPT_ERROR) from exc
+        finally:
+            if not finished:
+                process.kill()
+            process.stdout.close()
+            returncode = process.wait()
+        if finished and returncode != 0:
+            raise RuntimeError(DECRYPT_ERROR)
 
 
 def main() -> int:
@@ -82,33 +164,30 @@ def main() -> int:
         print("Password cannot be empty.")
         return 1
 
-    with tempfile.TemporaryDirectory(prefix="coil_even_levels_") as temp_dir:
-        temp_path = Path(temp_dir)
-        decrypted_tar = temp_path / "even_levels.tar"
-        even_levels_dir = temp_path / "even_levels"
-        even_levels_dir.mkdir(parents=True, exist_ok=True)
+    try:
+        archive = SecretArchive(secret_archive, password, args.start, args.end)
+    except RuntimeError as exc:
+        print(exc)
+        return 1
 
-        try:
-            decrypt_secret_archive(secret_archive, password, decrypted_tar)
-            safe_extract_tar(decrypted_tar, even_levels_dir)
-        except RuntimeError as exc:
-            print(exc)
-            return 1
-        finally:
-            if decrypted_tar.exists():
-                decrypted_tar.unlink()
-
-        return evaluate.evaluate_and_log(
-            solver=args.solver,
-            start=args.start,
-            end=args.end,
-            timeout=args.timeout,
-            estimate=args.estimate,
-            debug=args.debug,
-            level_dirs=[Path(args.public_levels_dir), even_levels_dir],
-            mode="full-odd-even",
-            invocation_argv=sys.argv,
-        )
+    return evaluate.evaluate_and_log(
+        solver=args.solver,
+        start=args.start,
+        end=args.end,
+        timeout=args.timeout,
+        estimate=args.estimate,
+        debug=args.debug,
+        level_dirs=[Path(args.public_levels_dir)],
+        inline_levels=archive.levels(),
+        pipeline=args.pipeline,
+        worker=args.worker,
+        jobs=args.jobs,
+        nodes=args.nodes,
+        progress=args.progress,
+        progress_log=args.progress_log,
+        mode="full-odd-even",
+        invocation_argv=sys.argv,
+    )
 
 
 if __name__ == "__main__":
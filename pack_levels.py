@@ -0,0 +1,116 @@
+#!/usr/bin/env python3
+"""Pack a directory of level files into a single binary level pack.
+
+The checker and solver read level N of a pack named as `<pack>:<N>`, straight
+from the mapped file and without parsing.  The layout, little-endian
+throughout:
+
+    magic "COILPACK", version (u4), index entries (u4)
+    one entry per level number: offset (u8), width (u4), height (u4)
+    the boards, one bit per cell in row order, set for a wall, lowest bits
+    first, each starting on an 8-byte boundary
+
+Entry N describes level N, so entries for numbers with no level file are all
+zero.
+"""
+import argparse
+import struct
+import sys
+from pathlib import Path
+
+MAGIC = b"COILPACK"
+VERSION = 1
+HEADER = struct.Struct("<8sII")
+ENTRY = struct.Struct("<QII")
+
+
+def parse_level(text):
+    """Parse "x=<x>&y=<y>&board=<board>" into width, height and board."""
+    fields = dict(part.split("=", 1) for part in text.strip().split("&"))
+    width = int(fields["x"])
+    height = int(fields["y"])
+    board = fields["board"]
+    if len(board) < width * height or set(board[: width * height]) - {"X", "."}:
+        raise ValueError("invalid board")
+    return width, height, board[: width * height]
+
+
+def pack_walls(board):
+    """One bit per cell, set for a wall, lowest bits first."""
+    walls = bytearray((len(board) + 7) // 8)
+    for i, cell in enumerate(board):
+        if cell == "X":
+            walls[i >> 3] |= 1 << (i & 7)
+    return bytes(walls)
+
+
+def pack_levels(levels):
+    """Build a pack from a dict of level number to (width, height, board)."""
+    count = max(levels, default=-1) + 1
+    offset = HEADER.size + count * ENTRY.size
+    index = []
+    boards = []
+    for number in range(count):
+        if number not in levels:
+            index.append(ENTRY.pack(0, 0, 0))
+            continue
+        offset = (offset + 7) // 8 * 8
+        width, height, board = levels[number]
+        walls = pack_walls(board)
+        index.append(ENTRY.pack(offset, width, height))
+        boards.append((offset, walls))
+        offset += len(walls)
+
+    data = bytearray(HEADER.pack(MAGIC, VERSION, count) + b"".join(index))
+    for start, walls in boards:
+        data += bytes(start - len(data))
+        data += walls
+    return bytes(data)
+
+
+def read_level(pack, number):
+    """Return (width, height, board) for a level of the bytes of a pack."""
+    magic, version, count = HEADER.unpack_from(pack)
+    if magic != MAGIC or version != VERSION:
+        raise ValueError("invalid level pack")
+    if number >= count:
+        raise KeyError(number)
+    offset, width, height = ENTRY.unpack_from(pack, HEADER.size + number * ENTRY.size)
+    if width == 0:
+        raise KeyError(number)
+    board = "".join(
+        "X" if pack[offset + (i >> 3)] >> (i & 7) & 1 else "."
+        for i in range(width * height)
+    )
+    return width, height, board
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Pack level files into a binary level pack.")
+    parser.add_argument("levels_dir", type=Path, help="Directory of level files named by number")
+    parser.add_argument("output", type=Path, help="Pack file to write")
+    args = parser.parse_args()
+
+    levels = {}
+    for path in sorted(args.levels_dir.iterdir()):
+        if not path.name.isdigit():
+            continue
+        try:
+            levels[int(path.name)] = parse_level(path.read_text())
+        except (KeyError, ValueError) as exc:
+            print(f"Error: could not parse level file '{path}': {exc}", file=sys.stderr)
+            return 1
+    if not levels:
+        print(f"Error: no level files found in '{args.levels_dir}'.", file=sys.stderr)
+        return 1
+
+    data = pack_levels(levels)
+    for number, level in levels.items():
+        assert read_level(data, number) == level
+    args.output.write_bytes(data)
+    print(f"Packed {len(levels)} levels into {args.output} ({len(data)} bytes)")
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,102 @@
+#!/usr/bin/env python3
+"""Write Coil solutions as qpaths.
+
+A qpath leaves out the moves the checker makes by itself.  After every slide
+the checker looks at the free neighbours in L, U, R, D order and carries on
+into the first one, unless it is L or U and the opposite way is free too, in
+which case the next move is read from the qpath.  The moves it makes by
+itself are the ones left out here, so what is left is the shortest qpath for
+the walk.  It is the same rule as encode_qpath() in coil_check/encode.c.
+"""
+import sys
+
+ORDER = "LURD"
+
+
+def parse_fields(text):
+    """Split "a=1&b=2" into a dict."""
+    return dict(part.split("=", 1) for part in text.strip().split("&"))
+
+
+def encode_qpath(width, height, board, x, y, path):
+    """Return the qpath moves for the walk from (x, y) taking path, or None.
+
+    board is the string of '.' and 'X' of a level.  None means the walk does
+    not visit every free cell, or cannot be written as a qpath because the
+    checker would carry on by itself in a direction the path does not take.
+    A walk that stops short is never rewritten: as a qpath the checker might
+    carry on where the path stopped.
+    """
+    stride = width + 2
+    cells = bytearray((width + 2) * (height + 2))
+    for row in range(height):
+        line = board[row * width : (row + 1) * width]
+        start = (row + 1) * stride + 1
+        cells[start : start + width] = bytes(c == "." for c in line)
+    delta = (-1, -stride, 1, stride)
+
+    i = (y + 1) * stride + x + 1
+    cells[i] = 0
+    moves = []
+    for m, move in enumerate(path):
+        direction = ORDER.index(move)
+        emit = True
+        if m != 0:
+            # The checker's rule for a move it makes by itself.
+            for k in range(4):
+                if not cells[i + delta[k]]:
+                    continue
+                if k < 2 and cells[i + delta[k + 2]]:
+                    break
+                if k != direction:
+                    return None
+                emit = False
+                break
+        if emit:
+            moves.append(move)
+        d = delta[direction]
+        while cells[i + d]:
+            i += d
+            cells[i] = 0
+    if any(cells):
+        return None
+    return "".join(moves)
+
+
+def compress_solution(level, solution):
+    """Rewrite a "x=<x>&y=<y>&path=<path>" solution to the level as a qpath.
+
+    Anything else, or a path that cannot be written as a qpath, comes back
+    as it was.
+    """
+    try:
+        fields = parse_fields(solution)
+        if set(fields) != {"x", "y", "path"}:
+            return solution
+        board = parse_fields(level)
+        width, height = int(board["x"]), int(board["y"])
+        x, y = int(fields["x"]), int(fields["y"])
+        if len(board["board"]) < width * height or not (0 <= x < width and 0 <= y < height):
+            return solution
+        if set(fields["path"]) - set(ORDER) or board["board"][y * width + x] != ".":
+            return solution
+        moves = encode_qpath(width, height, board["board"], x, y, fields["path"])
+    except (KeyError, ValueError):
+        return solution
+    if moves is None:
+        return solution
+    return f"x={x}&y={y}&qpath={moves}"
+
+
+def main():
+    if len(sys.argv) != 2:
+        print(f"Usage: {sys.argv[0]} <level file> < solution", file=sys.stderr)
+        return 1
+    with open(sys.argv[1]) as f:
+        level = f.read()
+    print(compress_solution(level, sys.stdin.read().strip()))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())